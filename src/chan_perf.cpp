@@ -1,31 +1,115 @@
+#include <pthread.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <vector>
 #include <thread>
 #include "snackis/core/chan.hpp"
+#include "snackis/core/fmt.hpp"
+#include "snackis/core/ring.hpp"
+#include "snackis/core/time.hpp"
 
 using namespace snackis;
 
-void run_pub(Chan<int> *ch, int reps) {
+enum Scenario { SCN_DEFAULT, SCN_PINNED, SCN_OVERSUB };
+enum Format { FMT_CSV, FMT_JSON };
+
+struct Result {
+  str impl, scenario;
+  int workers, reps, buf;
+  int64_t usecs, ops_per_sec, p50_ns, p99_ns, p999_ns;
+};
+
+static int64_t stamp() {
+  return nsecs(pnow().time_since_epoch());
+}
+
+template <typename ChanT>
+void run_pub(ChanT *ch, int reps) {
   for (int i(0); i < reps; i++) {
-    put(*ch, i);
+    put(*ch, stamp());
   }
 }
 
-void run_con(Chan<int> *ch, int reps) {
+template <typename ChanT>
+void run_con(ChanT *ch, int reps, std::vector<int64_t> *lats) {
+  lats->reserve(reps);
+
   for (int i(0); i < reps; i++) {
-    get(*ch);
+    auto sent(get(*ch));
+    if (sent) { lats->push_back(stamp()-*sent); }
   }
 }
 
-void run(int workers, int reps, int buf) {
+static void pin(std::thread &t, int core) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(core % std::thread::hardware_concurrency(), &cpus);
+  pthread_setaffinity_np(t.native_handle(), sizeof cpus, &cpus);
+}
+
+static int64_t percentile(const std::vector<int64_t> &lats, double p) {
+  if (lats.empty()) { return 0; }
+  return lats[std::min(size_t(lats.size()*p), lats.size()-1)];
+}
+
+template <typename ChanT>
+Result run(const str &impl, Scenario scn, int workers, int reps, int buf) {
   std::vector<std::thread> wg;
-  Chan<int> ch(buf);
-  
+  std::vector<std::vector<int64_t>> lats(workers);
+  ChanT ch(buf);
+  auto start(pnow());
+
   for (int i(0); i < workers; i++) {
-    wg.emplace_back(run_pub, &ch, reps);
-    wg.emplace_back(run_con, &ch, reps);
+    wg.emplace_back(run_pub<ChanT>, &ch, reps);
+    if (scn == SCN_PINNED) { pin(wg.back(), i*2); }
+    wg.emplace_back(run_con<ChanT>, &ch, reps, &lats[i]);
+    if (scn == SCN_PINNED) { pin(wg.back(), i*2+1); }
   }
 
   for (auto &t: wg) { t.join(); }
+  const int64_t us(std::max(usecs(pnow()-start), int64_t(1)));
+  std::vector<int64_t> all;
+  for (auto &l: lats) { all.insert(all.end(), l.begin(), l.end()); }
+  std::sort(all.begin(), all.end());
+
+  Result res;
+  res.impl = impl;
+  res.scenario =
+    (scn == SCN_PINNED) ? "pinned" : (scn == SCN_OVERSUB) ? "oversub" : "default";
+  res.workers = workers;
+  res.reps = reps;
+  res.buf = buf;
+  res.usecs = us;
+  res.ops_per_sec = int64_t(workers) * reps * 1000000 / us;
+  res.p50_ns = percentile(all, 0.5);
+  res.p99_ns = percentile(all, 0.99);
+  res.p999_ns = percentile(all, 0.999);
+  return res;
+}
+
+static void print(const Result &res, Format f) {
+  if (f == FMT_JSON) {
+    std::cout << fmt("{\"impl\": \"%0\", \"scenario\": \"%1\", "
+		     "\"workers\": %2, \"reps\": %3, \"buf\": %4, "
+		     "\"usecs\": %5, \"ops_per_sec\": %6, ",
+		     res.impl, res.scenario, res.workers, res.reps, res.buf,
+		     res.usecs, res.ops_per_sec)
+	      << fmt("\"p50_ns\": %0, \"p99_ns\": %1, \"p999_ns\": %2}",
+		     res.p50_ns, res.p99_ns, res.p999_ns)
+	      << std::endl;
+  } else {
+    std::cout << fmt("%0,%1,%2,%3,%4,%5,%6,",
+		     res.impl, res.scenario, res.workers, res.reps, res.buf,
+		     res.usecs, res.ops_per_sec)
+	      << fmt("%0,%1,%2", res.p50_ns, res.p99_ns, res.p999_ns)
+	      << std::endl;
+  }
+}
+
+static void run_all(Scenario scn, int workers, int reps, int buf, Format f) {
+  print(run<Chan<int64_t>>("chan", scn, workers, reps, buf), f);
+  print(run<Ring<int64_t>>("ring", scn, workers, reps, buf), f);
 }
 
 const int
@@ -33,12 +117,26 @@ const int
   MAX_REPS(1000000),
   MAX_BUF(    1000);
 
-int main() {
-  for (int workers(1); workers < MAX_WORKERS; workers++) {
-    for(int reps(10); reps < MAX_REPS; reps *= 10) {
-      for(int buf(1); buf < MAX_BUF; buf *= 10) {
-	run(workers, reps, buf);
+int main(int argc, char **argv) {
+  const Format f((argc > 1 && strcmp(argv[1], "--json") == 0)
+		 ? FMT_JSON
+		 : FMT_CSV);
+
+  if (f == FMT_CSV) {
+    std::cout << "impl,scenario,workers,reps,buf,usecs,ops_per_sec,"
+	      << "p50_ns,p99_ns,p999_ns" << std::endl;
+  }
+
+  const int oversub(std::max(int(std::thread::hardware_concurrency()), 1)*2);
+
+  for(int reps(10); reps < MAX_REPS; reps *= 10) {
+    for(int buf(1); buf < MAX_BUF; buf *= 10) {
+      for (int workers(1); workers < MAX_WORKERS; workers++) {
+	run_all(SCN_DEFAULT, workers, reps, buf, f);
+	run_all(SCN_PINNED, workers, reps, buf, f);
       }
+
+      run_all(SCN_OVERSUB, oversub, reps, buf, f);
     }
   }
 
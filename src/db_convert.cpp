@@ -0,0 +1,38 @@
+#include <iostream>
+
+#include "snackis/ctx.hpp"
+#include "snackis/snackis.hpp"
+#include "snackis/db/proc.hpp"
+
+using namespace snackis;
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: db_convert <path> <password>" << std::endl;
+    return -1;
+  }
+
+  error_handler = [](auto &errors) {
+    for (auto e: errors) { std::cerr << e->what << std::endl; }
+  };
+
+  TRY(try_convert);
+  init();
+  db::Proc proc(argv[1], 32);
+  proc.logger = [](const str &msg) { std::cout << msg << std::endl; };
+  Ctx ctx(proc, 32);
+
+  if (!db::login(ctx, argv[2])) {
+    std::cerr << "Login failed" << std::endl;
+    return -1;
+  }
+
+  open(ctx);
+  if (!try_convert.errors.empty()) { return -1; }
+  const int64_t reclaimed(rewrite_db(ctx));
+  if (!try_convert.errors.empty()) { return -1; }
+  
+  std::cout << fmt("Converted database to revision %0, %1k reclaimed",
+		   DB_REV, reclaimed / 1000) << std::endl;
+  return 0;
+}
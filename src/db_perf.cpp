@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "snackis/core/int64_type.hpp"
+#include "snackis/core/str_type.hpp"
+#include "snackis/core/stream.hpp"
+#include "snackis/core/time.hpp"
+#include "snackis/core/time_type.hpp"
+#include "snackis/core/uid_type.hpp"
+#include "snackis/db/col.hpp"
+#include "snackis/db/proc.hpp"
+#include "snackis/db/slot_table.hpp"
+#include "snackis/db/table.hpp"
+
+using namespace snackis;
+using namespace snackis::db;
+
+static std::atomic<int64_t> alloc_bytes(0);
+
+void *operator new(size_t size) {
+  auto p(static_cast<size_t *>(malloc(size+sizeof(size_t))));
+  if (!p) { abort(); }
+  *p = size;
+  alloc_bytes += size;
+  return p+1;
+}
+
+void operator delete(void *p) noexcept {
+  if (!p) { return; }
+  auto sp(static_cast<size_t *>(p)-1);
+  alloc_bytes -= *sp;
+  free(sp);
+}
+
+struct Row {
+  UId id;
+  int64_t num;
+  str text;
+  Time at;
+  std::set<str> tags;
+
+  Row(): id(true), num(0), at(now()) { }
+};
+
+const Col<Row, UId> row_id("id", uid_type, &Row::id);
+const Col<Row, int64_t> row_num("num", int64_type, &Row::num);
+const Col<Row, str> row_text("text", str_type, &Row::text);
+const Col<Row, Time> row_at("at", time_type, &Row::at);
+const Col<Row, std::set<str>> row_tags("tags", str_set_type, &Row::tags);
+
+const Schema<Row> row_cols({&row_num, &row_text, &row_at, &row_tags});
+
+const size_t
+  MAX_BUF(     100),
+  MAX_ROWS( 100000),
+  LOAD_ROWS(1000000);
+
+struct Result {
+  int64_t slurp_us, mem_bytes, scan_us, lookup_us, compare_us, sum;
+};
+
+static int64_t scan(Table<Row, UId> &tbl) {
+  int64_t sum(0);
+
+  for (auto &r: *tbl.recs) {
+    auto v(get(*r.second, row_num));
+    if (v) { sum += *v; }
+  }
+
+  return sum;
+}
+
+static int64_t scan(SlotTable<Row, UId> &tbl) {
+  const size_t slot(*find_slot(tbl, row_num));
+  auto &col(tbl.slots.cols[slot]);
+  int64_t sum(0);
+
+  for (size_t i(0); i < col.size(); i++) {
+    if (tbl.slots.masks[i].test(slot)) { sum += get<int64_t>(col[i]); }
+  }
+
+  return sum;
+}
+
+static bool lookup(Table<Row, UId> &tbl, const UId &id) {
+  return find(tbl, id) != nullptr;
+}
+
+static bool lookup(SlotTable<Row, UId> &tbl, const UId &id) {
+  return find_row(tbl, tbl.key(id)).has_value();
+}
+
+static int64_t compare_all(Table<Row, UId> &tbl) {
+  int64_t out(0);
+  auto prev(tbl.recs->begin());
+
+  for (auto i(std::next(prev)); i != tbl.recs->end(); prev = i, i++) {
+    out += compare(tbl, *prev->second, *i->second);
+  }
+
+  return out;
+}
+
+static int64_t compare_all(SlotTable<Row, UId> &tbl) {
+  int64_t out(0);
+  auto prev(tbl.rows.begin());
+
+  for (auto i(std::next(prev)); i != tbl.rows.end(); prev = i, i++) {
+    out += compare(tbl.slots, prev->second, i->second);
+  }
+
+  return out;
+}
+
+template <typename TblT>
+static Result run(TblT &tbl, const str &data, const std::vector<UId> &ids) {
+  Result res;
+  InStream in(data);
+
+  auto mem_start(alloc_bytes.load());
+  auto start(pnow());
+  slurp(tbl, in);
+  res.slurp_us = usecs(pnow()-start);
+  res.mem_bytes = alloc_bytes.load()-mem_start;
+
+  start = pnow();
+  res.sum = scan(tbl);
+  res.scan_us = usecs(pnow()-start);
+
+  start = pnow();
+  for (auto &id: ids) { CHECK(lookup(tbl, id), _); }
+  res.lookup_us = usecs(pnow()-start);
+
+  start = pnow();
+  res.sum += compare_all(tbl);
+  res.compare_us = usecs(pnow()-start);
+  return res;
+}
+
+static void print(const str &id, size_t rows, const Result &res) {
+  std::cout << std::setw(6) << id
+	    << std::setw(10) << rows
+	    << std::setw(12) << res.slurp_us
+	    << std::setw(12) << res.mem_bytes / 1024
+	    << std::setw(12) << res.scan_us
+	    << std::setw(12) << res.lookup_us
+	    << std::setw(12) << res.compare_us
+	    << std::endl;
+}
+
+static void gen_file(Table<Row, UId> &tbl, size_t rows, std::mt19937 &rnd) {
+  std::ofstream out(tbl.path.string(),
+		    std::ios::out | std::ios::binary | std::ios::trunc);
+  
+  for (size_t i(0); i < rows; i++) {
+    Row r;
+    r.num = rnd() % 1000;
+    r.text = fmt("Row %0 with a moderately sized text body", i);
+    r.tags.insert(fmt("tag%0", rnd() % 10));
+    write(out, TABLE_INSERT, Rec<Row>(tbl, r));
+  }
+}
+
+static void load_file(db::Ctx &ctx, std::mt19937 &rnd) {
+  Table<Row, UId> src(ctx, "perf_load", make_key(row_id), row_cols);
+  gen_file(src, LOAD_ROWS, rnd);
+
+  Table<Row, UId> stream_tbl(ctx, "perf_load", make_key(row_id), row_cols);
+  std::ifstream in(src.path.string(), std::ios::in | std::ios::binary);
+  auto start(pnow());
+  slurp(stream_tbl, in);
+  const int64_t stream_us(usecs(pnow()-start));
+  
+  Table<Row, UId> mmap_tbl(ctx, "perf_load", make_key(row_id), row_cols);
+  start = pnow();
+  slurp(mmap_tbl);
+  const int64_t mmap_us(usecs(pnow()-start));
+
+  CHECK(stream_tbl.recs->size() == LOAD_ROWS, _);
+  CHECK(mmap_tbl.recs->size() == LOAD_ROWS, _);
+  CHECK(scan(stream_tbl) == scan(mmap_tbl), _);
+  
+  std::cout << std::endl
+	    << std::setw(6) << "load"
+	    << std::setw(10) << "rows"
+	    << std::setw(12) << "stream(us)"
+	    << std::setw(12) << "mmap(us)"
+	    << std::endl
+	    << std::setw(6) << "file"
+	    << std::setw(10) << LOAD_ROWS
+	    << std::setw(12) << stream_us
+	    << std::setw(12) << mmap_us
+	    << std::endl;
+}
+
+int main() {
+  TRY(try_perf);
+  Proc proc("perfdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  std::mt19937 rnd(42);
+
+  std::cout << std::setw(6) << "table"
+	    << std::setw(10) << "rows"
+	    << std::setw(12) << "slurp(us)"
+	    << std::setw(12) << "mem(kB)"
+	    << std::setw(12) << "scan(us)"
+	    << std::setw(12) << "lookup(us)"
+	    << std::setw(12) << "cmp(us)"
+	    << std::endl;
+
+  for (size_t rows(1000); rows <= MAX_ROWS; rows *= 10) {
+    Table<Row, UId> src(ctx, "perf_src", make_key(row_id), row_cols);
+    OutStream buf;
+    std::vector<UId> ids;
+
+    for (size_t i(0); i < rows; i++) {
+      Row r;
+      r.num = rnd() % 1000;
+      r.text = fmt("Row %0 with a moderately sized text body", i);
+      r.tags.insert(fmt("tag%0", rnd() % 10));
+      write(buf, TABLE_INSERT, Rec<Row>(src, r));
+      ids.push_back(r.id);
+    }
+
+    std::shuffle(ids.begin(), ids.end(), rnd);
+    const str data(buf.str());
+
+    Table<Row, UId> rec_tbl(ctx, "perf_rec", make_key(row_id), row_cols);
+    auto rec_res(run(rec_tbl, data, ids));
+    print("rec", rows, rec_res);
+
+    SlotTable<Row, UId> slot_tbl(ctx, "perf_slot", make_key(row_id), row_cols);
+    auto slot_res(run(slot_tbl, data, ids));
+    print("slot", rows, slot_res);
+
+    CHECK(rec_res.sum == slot_res.sum, _);
+  }
+
+  load_file(ctx, rnd);
+  return 0;
+}
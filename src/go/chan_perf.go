@@ -1,55 +1,161 @@
 package main
 
 import (
+	"fmt"
+	"os"
 	"runtime"
+	"sort"
 	"sync"
+	"syscall"
+	"time"
+	"unsafe"
 )
 
-func run_pub(wg *sync.WaitGroup, ch chan int, reps int) {
+const (
+	SCN_DEFAULT = "default"
+	SCN_PINNED  = "pinned"
+	SCN_OVERSUB = "oversub"
+)
+
+type Result struct {
+	scenario                string
+	workers, reps, buf      int
+	usecs, ops_per_sec      int64
+	p50_ns, p99_ns, p999_ns int64
+}
+
+func pin(core int) {
+	var mask [16]uint64
+	core %= runtime.NumCPU()
+	mask[core/64] |= 1 << uint(core%64)
+	syscall.RawSyscall(syscall.SYS_SCHED_SETAFFINITY, 0,
+		uintptr(len(mask)*8), uintptr(unsafe.Pointer(&mask[0])))
+}
+
+func run_pub(wg *sync.WaitGroup, ch chan int64, reps int, core int) {
 	runtime.LockOSThread()
-	
+	if core >= 0 {
+		pin(core)
+	}
+
 	for i := 0; i < reps; i++ {
-		ch<- i
+		ch <- time.Now().UnixNano()
 	}
-	
+
 	wg.Done()
 }
 
-func run_con(wg *sync.WaitGroup, ch chan int, reps int) {
+func run_con(wg *sync.WaitGroup, ch chan int64, reps int, core int, lats *[]int64) {
 	runtime.LockOSThread()
+	if core >= 0 {
+		pin(core)
+	}
 
 	for i := 0; i < reps; i++ {
-		<-ch
+		sent := <-ch
+		*lats = append(*lats, time.Now().UnixNano()-sent)
 	}
-	
+
 	wg.Done()
 }
 
-func run(workers, reps, buf int) {
+func percentile(lats []int64, p float64) int64 {
+	if len(lats) == 0 {
+		return 0
+	}
+
+	i := int(float64(len(lats)) * p)
+	if i > len(lats)-1 {
+		i = len(lats) - 1
+	}
+
+	return lats[i]
+}
+
+func run(scn string, workers, reps, buf int) Result {
 	var wg sync.WaitGroup
-	ch := make(chan int, buf)
-	
+	ch := make(chan int64, buf)
+	lats := make([][]int64, workers)
+	start := time.Now()
+
 	for i := 0; i < workers; i++ {
+		pub, con := -1, -1
+
+		if scn == SCN_PINNED {
+			pub, con = i*2, i*2+1
+		}
+
+		lats[i] = make([]int64, 0, reps)
 		wg.Add(2)
-		go run_pub(&wg, ch, reps)
-		go run_con(&wg, ch, reps)
+		go run_pub(&wg, ch, reps, pub)
+		go run_con(&wg, ch, reps, con, &lats[i])
 	}
 
 	wg.Wait()
+	us := time.Since(start).Nanoseconds() / 1000
+	if us < 1 {
+		us = 1
+	}
+
+	var all []int64
+	for _, l := range lats {
+		all = append(all, l...)
+	}
+
+	sort.Slice(all, func(i, j int) bool { return all[i] < all[j] })
+
+	return Result{
+		scenario:    scn,
+		workers:     workers,
+		reps:        reps,
+		buf:         buf,
+		usecs:       us,
+		ops_per_sec: int64(workers) * int64(reps) * 1000000 / us,
+		p50_ns:      percentile(all, 0.5),
+		p99_ns:      percentile(all, 0.99),
+		p999_ns:     percentile(all, 0.999),
+	}
+}
+
+func print(res Result, json bool) {
+	if json {
+		fmt.Printf("{\"impl\": \"go\", \"scenario\": \"%s\", "+
+			"\"workers\": %d, \"reps\": %d, \"buf\": %d, "+
+			"\"usecs\": %d, \"ops_per_sec\": %d, "+
+			"\"p50_ns\": %d, \"p99_ns\": %d, \"p999_ns\": %d}\n",
+			res.scenario, res.workers, res.reps, res.buf,
+			res.usecs, res.ops_per_sec, res.p50_ns, res.p99_ns, res.p999_ns)
+	} else {
+		fmt.Printf("go,%s,%d,%d,%d,%d,%d,%d,%d,%d\n",
+			res.scenario, res.workers, res.reps, res.buf,
+			res.usecs, res.ops_per_sec, res.p50_ns, res.p99_ns, res.p999_ns)
+	}
 }
 
 const (
-	MAX_WORKERS =    5
-	MAX_REPS = 1000000
-	MAX_BUF =     1000
+	MAX_WORKERS = 5
+	MAX_REPS    = 1000000
+	MAX_BUF     = 1000
 )
 
 func main() {
-	for workers := 1; workers < MAX_WORKERS; workers++ {
-		for reps := 10; reps < MAX_REPS; reps *= 10 {
-			for buf := 1; buf < MAX_BUF; buf *= 10 {
-				run(workers, reps, buf)
+	json := len(os.Args) > 1 && os.Args[1] == "--json"
+
+	if !json {
+		fmt.Println("impl,scenario,workers,reps,buf,usecs,ops_per_sec," +
+			"p50_ns,p99_ns,p999_ns")
+	}
+
+	oversub := runtime.NumCPU() * 2
+
+	for reps := 10; reps < MAX_REPS; reps *= 10 {
+		for buf := 1; buf < MAX_BUF; buf *= 10 {
+			for workers := 1; workers < MAX_WORKERS; workers++ {
+				print(run(SCN_DEFAULT, workers, reps, buf), json)
+				print(run(SCN_PINNED, workers, reps, buf), json)
 			}
+
+			print(run(SCN_OVERSUB, oversub, reps, buf), json)
 		}
 	}
 }
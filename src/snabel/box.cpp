@@ -12,6 +12,25 @@ namespace snabel {
     type(&get_opt_type(scp.exec, t)), safe_level(scp.safe_level)
   { }
 
+  Box &Box::operator =(const Box &src) {
+    if (&src != this) {
+      Box tmp(src);
+      *this = std::move(tmp);
+    }
+
+    return *this;
+  }
+
+  Box &Box::operator =(Box &&src) {
+    if (&src != this) {
+      type = src.type;
+      safe_level = src.safe_level;
+      val = std::move(src.val);
+    }
+
+    return *this;
+  }
+
   FuncAppError::FuncAppError(const Func &fn, const Stack &s):
     SnabelError(fmt("Function not applicable: %0\n%1", name(fn.name), s))
   { }
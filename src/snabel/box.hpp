@@ -1,7 +1,12 @@
 #ifndef SNABEL_BOX_HPP
 #define SNABEL_BOX_HPP
 
-#include <any>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #include "snabel/error.hpp"
 #include "snackis/core/error.hpp"
 #include "snackis/core/fmt.hpp"
@@ -13,7 +18,201 @@ namespace snabel {
   struct Scope;
   struct Type;
   
-  using Val = std::any;
+  const size_t VAL_SIZE(24);
+
+  struct ValImp {
+    void (*copy)(void *dst, const void *src);
+    void (*move)(void *dst, void *src);
+    void (*drop)(void *val);
+  };
+
+  struct Val {
+    const ValImp *imp;
+    alignas(int64_t) unsigned char data[VAL_SIZE];
+
+    Val();
+    Val(const Val &src);
+    Val(Val &&src);
+
+    template <typename T,
+	      typename = std::enable_if_t<!std::is_same<std::decay_t<T>,
+							Val>::value>>
+    Val(T &&val);
+
+    ~Val();
+    Val &operator =(const Val &src);
+    Val &operator =(Val &&src);
+  };
+
+  template <typename T>
+  struct ValRef {
+    std::atomic<int64_t> refs;
+    T val;
+
+    template <typename...Args>
+    ValRef(Args &&...args);
+  };
+
+  template <typename T>
+  constexpr bool is_inline_val() {
+    return sizeof(T) <= VAL_SIZE &&
+      alignof(T) <= alignof(int64_t) &&
+      std::is_nothrow_move_constructible<T>::value;
+  }
+
+  template <typename T>
+  constexpr bool is_trivial_val() {
+    return is_inline_val<T>() && std::is_trivially_copyable<T>::value;
+  }
+
+  template <typename T>
+  void copy_inline_val(void *dst, const void *src) {
+    new (dst) T(*static_cast<const T *>(src));
+  }
+
+  template <typename T>
+  void move_inline_val(void *dst, void *src) {
+    new (dst) T(std::move(*static_cast<T *>(src)));
+    static_cast<T *>(src)->~T();
+  }
+
+  template <typename T>
+  void drop_inline_val(void *val) {
+    static_cast<T *>(val)->~T();
+  }
+
+  template <typename T>
+  void copy_ref_val(void *dst, const void *src) {
+    auto ref(*static_cast<ValRef<T> *const *>(src));
+    ref->refs++;
+    *static_cast<ValRef<T> **>(dst) = ref;
+  }
+
+  template <typename T>
+  void move_ref_val(void *dst, void *src) {
+    *static_cast<ValRef<T> **>(dst) = *static_cast<ValRef<T> **>(src);
+  }
+
+  template <typename T>
+  void drop_ref_val(void *val) {
+    auto ref(*static_cast<ValRef<T> **>(val));
+    if (--ref->refs == 0) { delete ref; }
+  }
+
+  template <typename T>
+  struct ValImps {
+    static const ValImp imp;
+  };
+
+  template <typename T>
+  const ValImp ValImps<T>::imp {
+    is_trivial_val<T>()
+      ? nullptr
+      : (is_inline_val<T>() ? copy_inline_val<T> : copy_ref_val<T>),
+    is_trivial_val<T>()
+      ? nullptr
+      : (is_inline_val<T>() ? move_inline_val<T> : move_ref_val<T>),
+    is_trivial_val<T>()
+      ? nullptr
+      : (is_inline_val<T>() ? drop_inline_val<T> : drop_ref_val<T>)
+  };
+  
+  template <typename T>
+  template <typename...Args>
+  ValRef<T>::ValRef(Args &&...args):
+    refs(1), val(std::forward<Args>(args)...)
+  { }
+
+  inline Val::Val():
+    imp(nullptr)
+  { }
+
+  inline Val::Val(const Val &src):
+    imp(src.imp)
+  {
+    if (imp && imp->copy) {
+      imp->copy(data, src.data);
+    } else {
+      memcpy(data, src.data, VAL_SIZE);
+    }
+  }
+
+  inline Val::Val(Val &&src):
+    imp(src.imp)
+  {
+    if (imp && imp->move) {
+      imp->move(data, src.data);
+      src.imp = nullptr;
+    } else {
+      memcpy(data, src.data, VAL_SIZE);
+    }
+  }
+
+  template <typename T, typename>
+  Val::Val(T &&val):
+    imp(&ValImps<std::decay_t<T>>::imp)
+  {
+    using V = std::decay_t<T>;
+
+    if constexpr (is_inline_val<V>()) {
+      new (data) V(std::forward<T>(val));
+    } else {
+      *reinterpret_cast<ValRef<V> **>(data) =
+	new ValRef<V>(std::forward<T>(val));
+    }
+  }
+
+  inline Val::~Val() {
+    if (imp && imp->drop) { imp->drop(data); }
+  }
+
+  inline Val &Val::operator =(const Val &src) {
+    if (&src != this) {
+      Val tmp(src);
+      this->~Val();
+      new (this) Val(std::move(tmp));
+    }
+
+    return *this;
+  }
+
+  inline Val &Val::operator =(Val &&src) {
+    if (&src != this) {
+      Val tmp(std::move(src));
+      this->~Val();
+      new (this) Val(std::move(tmp));
+    }
+
+    return *this;
+  }
+
+  inline bool empty(const Val &v) { return !v.imp; }
+
+  template <typename T>
+  const T &get(const Val &v) {
+    if constexpr (is_inline_val<T>()) {
+      return *reinterpret_cast<const T *>(v.data);
+    } else {
+      return (*reinterpret_cast<ValRef<T> *const *>(v.data))->val;
+    }
+  }
+
+  template <typename T>
+  T &get(Val &v) {
+    if constexpr (is_inline_val<T>()) {
+      return *reinterpret_cast<T *>(v.data);
+    } else {
+      auto &ref(*reinterpret_cast<ValRef<T> **>(v.data));
+
+      if (ref->refs.load() > 1) {
+	auto prev(ref);
+	ref = new ValRef<T>(prev->val);
+	if (--prev->refs == 0) { delete prev; }
+      }
+      
+      return ref->val;
+    }
+  }
   
   struct Box {
     Type *type;
@@ -22,6 +221,10 @@ namespace snabel {
     
     Box(Scope &scp, Type &t, const Val &v);
     Box(Scope &scp, Type &t);
+    Box(const Box &src) = default;
+    Box(Box &&src) = default;
+    Box &operator =(const Box &src);
+    Box &operator =(Box &&src);
   };
 
   using Stack = std::deque<Box>;
@@ -38,12 +241,12 @@ namespace snabel {
   
   template <typename T>
   constexpr const T &get(const Box &b) {
-    return *std::any_cast<T>(&b.val);
+    return get<T>(b.val);
   }
 
   template <typename T>
   constexpr T &get(Box &b) {
-    return *std::any_cast<T>(&b.val);
+    return get<T>(b.val);
   }
 }
 
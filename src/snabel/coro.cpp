@@ -46,8 +46,8 @@ namespace snabel {
   }
 
   void init_coros(Exec &exe) {
-    exe.coro_type.supers.push_back(&exe.any_type);
-    exe.coro_type.supers.push_back(&exe.callable_type);
+    add_super(exe, exe.coro_type, exe.any_type);
+    add_super(exe, exe.coro_type, exe.callable_type);
 
     exe.coro_type.fmt = [](auto &v) {
       auto &l(get<CoroRef>(v)->target->label);
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include "snabel/env.hpp"
+
+namespace snabel {
+  static Env::iterator find_pos(Env &env, const Sym &key) {
+    return std::lower_bound(env.begin(), env.end(), key,
+			    [](auto &x, auto &y) { return x.first < y; });
+  }
+  
+  Box *find_env(Env &env, const Sym &key) {
+    auto fnd(find_pos(env, key));
+    return (fnd == env.end() || !(fnd->first == key)) ? nullptr : &fnd->second;
+  }
+
+  void put_env(Env &env, const Sym &key, const Box &val) {
+    auto fnd(find_pos(env, key));
+
+    if (fnd == env.end() || !(fnd->first == key)) {
+      env.emplace(fnd, key, val);
+    } else {
+      fnd->second = val;
+    }
+  }
+
+  bool rem_env(Env &env, const Sym &key) {
+    auto fnd(find_pos(env, key));
+    if (fnd == env.end() || !(fnd->first == key)) { return false; }
+    env.erase(fnd);
+    return true;
+  }
+
+  void merge_env(Env &dst, const Env &src) {
+    for (auto &e: src) {
+      auto fnd(find_pos(dst, e.first));
+      if (fnd == dst.end() || !(fnd->first == e.first)) { dst.insert(fnd, e); }
+    }
+  }
+
+  void add_sym(Syms &syms, const Sym &sym) {
+    auto fnd(std::lower_bound(syms.begin(), syms.end(), sym));
+    if (fnd == syms.end() || !(*fnd == sym)) { syms.insert(fnd, sym); }
+  }
+}
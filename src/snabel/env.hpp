@@ -1,12 +1,21 @@
 #ifndef SNABEL_ENV_HPP
 #define SNABEL_ENV_HPP
 
-#include <map>
+#include <utility>
+#include <vector>
+
 #include "snabel/box.hpp"
 #include "snabel/sym.hpp"
 
 namespace snabel {
-  using Env = std::map<Sym, Box>;
+  using Env = std::vector<std::pair<Sym, Box>>;
+  using Syms = std::vector<Sym>;
+
+  Box *find_env(Env &env, const Sym &key);
+  void put_env(Env &env, const Sym &key, const Box &val);
+  bool rem_env(Env &env, const Sym &key);
+  void merge_env(Env &dst, const Env &src);
+  void add_sym(Syms &syms, const Sym &sym);
 }
 
 #endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <fcntl.h>
 #include <unistd.h>
@@ -301,6 +302,7 @@ namespace snabel {
   }
   
   Exec::Exec():
+    type_rev(0),
     main(make_main(*this)),
     main_scope(main.scopes.at(0)),
     meta_type(get_sym(*this, "Type<Any>")),
@@ -390,7 +392,7 @@ namespace snabel {
     any_type.fmt = [](auto &v) { return "Any"; };
     any_type.eq = [](auto &x, auto &y) { return false; };
 
-    meta_type.supers.push_back(&any_type);
+    add_super(*this, meta_type, any_type);
     meta_type.args.push_back(&any_type);
     meta_type.fmt = meta_fmt;
     meta_type.eq = meta_eq;
@@ -400,17 +402,17 @@ namespace snabel {
     void_type.fmt = [](auto &v) { return "Void"; };
     void_type.eq = [](auto &x, auto &y) { return true; };  
     
-    ordered_type.supers.push_back(&any_type);
+    add_super(*this, ordered_type, any_type);
 
-    callable_type.supers.push_back(&any_type);
+    add_super(*this, callable_type, any_type);
     callable_type.args.push_back(&any_type);
 
-    nop_type.supers.push_back(&callable_type);
+    add_super(*this, nop_type, callable_type);
     nop_type.fmt = [](auto &v) { return "&nop"; };
     nop_type.eq = [](auto &x, auto &y) { return true; };  
     nop_type.call = [](auto &scp, auto &v, bool now) { return true; };
     
-    drop_type.supers.push_back(&callable_type);
+    add_super(*this, drop_type, callable_type);
     drop_type.fmt = [](auto &v) { return "&_"; };
     drop_type.eq = [](auto &x, auto &y) { return true; };  
 
@@ -418,7 +420,7 @@ namespace snabel {
       return try_pop(scp.thread) ? true : false;
     };
     
-    iter_type.supers.push_back(&any_type);
+    add_super(*this, iter_type, any_type);
     iter_type.args.push_back(&any_type);
 
     iter_type.fmt = [](auto &v) {
@@ -431,7 +433,7 @@ namespace snabel {
     
     iter_type.iter = [](auto &in) { return get<IterRef>(in); };
 
-    iterable_type.supers.push_back(&any_type);
+    add_super(*this, iterable_type, any_type);
     iterable_type.args.push_back(&any_type);
 
     iterable_type.fmt = [](auto &v) {
@@ -440,15 +442,15 @@ namespace snabel {
 
     iterable_type.eq = [](auto &x, auto &y) { return false; };
 
-    readable_type.supers.push_back(&any_type);
-    writeable_type.supers.push_back(&any_type);
+    add_super(*this, readable_type, any_type);
+    add_super(*this, writeable_type, any_type);
     
-    path_type.supers.push_back(&any_type);
+    add_super(*this, path_type, any_type);
     path_type.fmt = [](auto &v) { return get<Path>(v).string(); };
     path_type.eq = [](auto &x, auto &y) { return get<Path>(x) == get<Path>(y); };
 
-    bin_type.supers.push_back(&any_type);
-    bin_type.supers.push_back(&get_iterable_type(*this, byte_type));
+    add_super(*this, bin_type, any_type);
+    add_super(*this, bin_type, get_iterable_type(*this, byte_type));
     bin_type.fmt = [](auto &v) { return fmt("Bin(%0)", get<BinRef>(v)->size()); };
     bin_type.eq = [](auto &x, auto &y) { return get<BinRef>(x) == get<BinRef>(y); };
     bin_type.equal = [](auto &x, auto &y) {
@@ -458,19 +460,19 @@ namespace snabel {
       return IterRef(new BinIter(*this, get<BinRef>(in)));
     };
 
-    byte_type.supers.push_back(&any_type);
-    byte_type.supers.push_back(&ordered_type);
+    add_super(*this, byte_type, any_type);
+    add_super(*this, byte_type, ordered_type);
     byte_type.fmt = [](auto &v) { return fmt_arg(get<Byte>(v)); };
     byte_type.eq = [](auto &x, auto &y) { return get<Byte>(x) == get<Byte>(y); };
     byte_type.lt = [](auto &x, auto &y) { return get<Byte>(x) < get<Byte>(y); };
 
-    bool_type.supers.push_back(&any_type);
+    add_super(*this, bool_type, any_type);
     bool_type.fmt = [](auto &v) { return get<bool>(v) ? "true" : "false"; };
     bool_type.eq = [](auto &x, auto &y) { return get<bool>(x) == get<bool>(y); };
     put_env(scp, "true", Box(scp, bool_type, true));
     put_env(scp, "false", Box(scp, bool_type, false));
 
-    macro_type.supers.push_back(&any_type);
+    add_super(*this, macro_type, any_type);
 
     macro_type.fmt = [](auto &v) {
       return fmt("Macro(%0)", name(get<Macro *>(v)->name));
@@ -480,8 +482,8 @@ namespace snabel {
       return get<Macro *>(x) == get<Macro *>(y);
     };
 
-    func_type.supers.push_back(&any_type);
-    func_type.supers.push_back(&callable_type);
+    add_super(*this, func_type, any_type);
+    add_super(*this, func_type, callable_type);
 
     func_type.fmt = [](auto &v) {
       return fmt("Func(%0)", name(get<Func *>(v)->name));
@@ -504,10 +506,10 @@ namespace snabel {
       return (*m->first)(scp, m->second);
     };
 
-    num_type.supers.push_back(&ordered_type);
+    add_super(*this, num_type, ordered_type);
 
-    i64_type.supers.push_back(&num_type);
-    i64_type.supers.push_back(&get_iterable_type(*this, i64_type));
+    add_super(*this, i64_type, num_type);
+    add_super(*this, i64_type, get_iterable_type(*this, i64_type));
     i64_type.fmt = [](auto &v) { return fmt_arg(get<int64_t>(v)); };
     i64_type.eq = [](auto &x, auto &y) { return get<int64_t>(x) == get<int64_t>(y); };
     i64_type.lt = [](auto &x, auto &y) { return get<int64_t>(x) < get<int64_t>(y); };
@@ -516,8 +518,8 @@ namespace snabel {
       return IterRef(new RangeIter(*this, Range(0, get<int64_t>(in))));
     };
     
-    label_type.supers.push_back(&any_type);
-    label_type.supers.push_back(&callable_type);
+    add_super(*this, label_type, any_type);
+    add_super(*this, label_type, callable_type);
     
     label_type.fmt = [](auto &v) {
       auto &l(*get<Label *>(v));
@@ -533,7 +535,7 @@ namespace snabel {
       return true;
     };
 
-    lambda_type.supers.push_back(&callable_type);
+    add_super(*this, lambda_type, callable_type);
 
     lambda_type.fmt = [](auto &v) {
       auto &l(get<LambdaRef>(v)->label);
@@ -549,14 +551,14 @@ namespace snabel {
       return true;
     };
         
-    uid_type.supers.push_back(&any_type);
-    uid_type.supers.push_back(&ordered_type);
+    add_super(*this, uid_type, any_type);
+    add_super(*this, uid_type, ordered_type);
     uid_type.fmt = [](auto &v) { return fmt("Uid(%0)", get<Uid>(v)); };
     uid_type.eq = [](auto &x, auto &y) { return get<Uid>(x) == get<Uid>(y); };
     uid_type.lt = [](auto &x, auto &y) { return get<Uid>(x) < get<Uid>(y); };
 
-    random_type.supers.push_back(&any_type);
-    random_type.supers.push_back(&get_iterable_type(*this, i64_type));
+    add_super(*this, random_type, any_type);
+    add_super(*this, random_type, get_iterable_type(*this, i64_type));
     
     random_type.fmt = [](auto &v) {
       auto &r(*get<RandomRef>(v));
@@ -861,7 +863,7 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &mt(add_type(exe, n, true));
     mt.raw = &exe.meta_type;
-    mt.supers.push_back(&exe.meta_type);
+    add_super(exe, mt, exe.meta_type);
     mt.args.push_back(&t);
     mt.fmt = meta_fmt;
     mt.eq = meta_eq;
@@ -870,9 +872,10 @@ namespace snabel {
 
   Type &add_type(Exec &exe, const Sym &n, bool meta) {
     auto &scp(curr_scope(exe));
-    auto fnd(find_env(scp, n));
     auto &t(exe.types.emplace_back(n));
+    exe.type_rev++;
     auto &mt(meta ? exe.meta_type : get_meta_type(exe, t));
+    auto fnd(find_env(scp, n));
     
     if (fnd) {
       fnd->type = &mt;
@@ -888,6 +891,11 @@ namespace snabel {
     return add_type(exe, get_sym(exe, n), meta);
   }
 
+  void add_super(Exec &exe, Type &t, Type &super) {
+    t.supers.push_back(&super);
+    exe.type_rev++;
+  }
+
   Type *find_type(Exec &exe, const Sym &n) {
     auto fnd(find_env(curr_scope(exe), n));
     if (!fnd) { return nullptr; }
@@ -944,9 +952,9 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &t(add_type(exe, n));
     t.raw = &exe.iter_type;
-    t.supers.push_back(&exe.any_type);
-    t.supers.push_back(&get_iterable_type(exe, elt));    
-    t.supers.push_back(&exe.iter_type);
+    add_super(exe, t, exe.any_type);
+    add_super(exe, t, get_iterable_type(exe, elt));
+    add_super(exe, t, exe.iter_type);
     t.args.push_back(&elt);
     t.fmt = exe.iter_type.fmt;
     t.eq = exe.iter_type.eq;
@@ -960,8 +968,8 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &t(add_type(exe, n));
     t.raw = &exe.iterable_type;
-    t.supers.push_back(&exe.any_type);
-    t.supers.push_back(&exe.iterable_type);
+    add_super(exe, t, exe.any_type);
+    add_super(exe, t, exe.iterable_type);
     t.args.push_back(&elt);
     t.fmt = exe.iterable_type.fmt;
     t.eq = exe.iterable_type.eq;
@@ -977,7 +985,9 @@ namespace snabel {
   }
 
   void rem_func(Func::ImpHandle hnd) {
-    hnd->func.imps.erase(hnd);
+    auto &fn(hnd->func);
+    fn.imps.erase(hnd);
+    fn.rev++;
   }
   
   Label &add_label(Exec &exe, const Sym &tag, bool pmt) {
@@ -1068,6 +1078,7 @@ namespace snabel {
 
     exe.next_uid.store(1);
     exe.main.ops.clear();
+    exe.main.code.clear();
     exe.main.pc = 0;
   }
 
@@ -1331,6 +1342,82 @@ namespace snabel {
     return compile(curr_thread(exe), in, skip);
   }
     
+  struct ResolveFrame {
+    Label &label;
+    Syms refs, defs;
+    bool dynamic;
+
+    ResolveFrame(Label &lbl): label(lbl), dynamic(false) { }
+  };
+
+  static void resolve_ref(Exec &exe, ResolveFrame &frm, const Sym &ref) {
+    if (ref == get_sym(exe, "eval")) { frm.dynamic = true; }
+    add_sym(frm.refs, ref);
+  }
+  
+  static void resolve(Exec &exe, OpSeq &in) {
+    std::vector<ResolveFrame> frames;
+    std::map<Label *, opt<Syms>> captures;
+    
+    for (auto &op: in) {
+      if (op.imp.code == OP_BEGIN) {
+	frames.emplace_back(std::get<Begin>(op.data).enter_label);
+	continue;
+      }
+
+      if (op.imp.code == OP_CAPTURE) {
+	auto &c(std::get<Capture>(op.data));
+	auto fnd(captures.find(&c.target));
+	if (fnd != captures.end()) { c.refs = fnd->second; }
+	continue;
+      }
+      
+      if (frames.empty()) { continue; }
+      auto &frm(frames.back());
+      
+      switch (op.imp.code) {
+      case OP_DEREF:
+	resolve_ref(exe, frm, std::get<Deref>(op.data).name);
+	break;
+      case OP_FMT:
+	for (auto &s: std::get<Fmt>(op.data).subs) {
+	  if (s.second.at(0) == '@') { resolve_ref(exe, frm, get_sym(exe, s.second)); }
+	}
+	
+	break;
+      case OP_FUNCALL:
+	resolve_ref(exe, frm, std::get<Funcall>(op.data).fn.name);
+	break;
+      case OP_GETENV: {
+	auto &id(std::get<Getenv>(op.data).id);
+	if (id) { resolve_ref(exe, frm, *id); }
+	else { frm.dynamic = true; }
+	break;
+      }
+      case OP_PUTENV:
+	add_sym(frm.defs, std::get<Putenv>(op.data).key);
+	break;
+      case OP_END: {
+	Syms refs;
+	std::set_difference(frm.refs.begin(), frm.refs.end(),
+			    frm.defs.begin(), frm.defs.end(),
+			    std::back_inserter(refs));
+	auto &cap(captures[&frm.label]);
+	if (!frm.dynamic) { cap.emplace(refs); }
+	bool dynamic(frm.dynamic);
+	frames.pop_back();
+	if (frames.empty()) { break; }
+	auto &prt(frames.back());
+	if (dynamic) { prt.dynamic = true; }
+	for (auto &r: refs) { add_sym(prt.refs, r); }
+	break;
+      }
+      default:
+	break;
+      }
+    }
+  }
+  
   bool compile(Thread &thd, OpSeq &in) {
     auto start_pc(thd.ops.size());
     TRY(try_compile);
@@ -1380,9 +1467,12 @@ namespace snabel {
       in.clear();
       in.swap(out_ops);
     }
+
+    resolve(thd.exec, in);
   exit:
     thd.pc = start_pc;
     std::copy(in.begin(), in.end(), std::back_inserter(thd.ops));
+    lower(thd, start_pc);
     return try_compile.errors.empty();
   }
   
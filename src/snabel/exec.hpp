@@ -27,6 +27,7 @@ namespace snabel {
     
     std::deque<Macro> macros;
     std::deque<Type> types;
+    std::atomic<int64_t> type_rev;
     Convs convs;
     std::map<Sym, Func> funcs;
     std::map<Sym, Label> labels;
@@ -66,6 +67,7 @@ namespace snabel {
   Type &get_meta_type(Exec &exe, Type &t);
   Type &add_type(Exec &exe, const Sym &n, bool meta=false);
   Type &add_type(Exec &exe, const str &n, bool meta=false);
+  void add_super(Exec &exe, Type &t, Type &super);
   Type *find_type(Exec &exe, const Sym &n);
   Type &get_type(Exec &exe, Type &raw, Types args);
   Type *get_super(Exec &exe, Type &raw, const Types &x, const Types &y);
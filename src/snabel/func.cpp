@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 
 #include "snabel/box.hpp"
 #include "snabel/error.hpp"
@@ -35,8 +37,21 @@ namespace snabel {
     return true;
   }
 
+  bool FuncImp::operator ()(Scope &scp) {
+    if (lambda) {
+      return call(lambda, scp, true);
+    }
+
+    auto &s(curr_stack(scp.thread));
+    auto i(std::next(s.begin(), s.size()-args.size()));
+    Args as(std::make_move_iterator(i), std::make_move_iterator(s.end()));
+    s.erase(i, s.end());
+    imp(scp, as);
+    return true;
+  }
+
   Func::Func(const Sym &n):
-    name(n)
+    name(n), rev(0)
   { }
 
   ArgType::ArgType(Type &type):
@@ -127,9 +142,67 @@ namespace snabel {
 					bool conv_args) {
     for (auto &imp: fn.imps) {
       auto args(match(imp, types, scp, conv_args));
-      if (args) { return std::make_pair(&imp, *args); }
+      if (args) { return std::make_pair(&imp, std::move(*args)); }
     }
 
     return conv_args ? nullopt : match(fn, types, scp, true);
   }
+
+  FuncImp *find_imp(FuncCache &cache, Func &fn, Scope &scp) {
+    auto &s(curr_stack(scp.thread));
+    auto type_rev(scp.exec.type_rev.load());
+    
+    for (auto &e: cache.entries) {
+      if (e.fn != &fn ||
+	  e.rev != fn.rev ||
+	  e.type_rev != type_rev ||
+	  s.size() < e.types.size()) {
+	continue;
+      }
+
+      auto i(std::next(s.begin(), s.size()-e.types.size()));
+      auto j(e.types.begin());
+      
+      for (; j != e.types.end() &&
+	     i->type == *j &&
+	     i->safe_level == scp.safe_level;
+	   i++, j++);
+      
+      if (j == e.types.end()) { return e.imp; }
+    }
+
+    return nullptr;
+  }
+
+  void cache_imp(FuncCache &cache, FuncImp &imp, const Args &args, Scope &scp) {
+    auto &fn(imp.func);
+    auto type_rev(scp.exec.type_rev.load());
+    
+    cache.entries.erase(std::remove_if(cache.entries.begin(), cache.entries.end(),
+				       [&fn, type_rev](auto &e) {
+					 return e.type_rev != type_rev ||
+					   (e.fn == &fn && e.rev != fn.rev);
+				       }),
+			cache.entries.end());
+
+    if (cache.entries.size() == FUNC_CACHE_MAX) { return; }
+    size_t len(0);
+    for (auto &i: fn.imps) { len = std::max(len, i.args.size()); }
+    auto &s(curr_stack(scp.thread));
+    if (s.size() < len) { return; }
+    auto i(std::next(s.begin(), s.size()-args.size()));
+    
+    for (auto &a: args) {
+      if (a.type != i->type) { return; }
+      i++;
+    }
+
+    Types types;
+    
+    std::transform(std::next(s.begin(), s.size()-len), s.end(),
+		   std::back_inserter(types),
+		   [](auto &v) { return v.type; });
+    
+    cache.entries.push_back({&fn, fn.rev, type_rev, types, &imp});
+  }
 }
@@ -58,6 +58,7 @@ namespace snabel {
 	    const LambdaRef &lmb);
 
     bool operator ()(Scope &scp, const Args &args);
+    bool operator ()(Scope &scp);
   };
 
   struct Func {
@@ -71,9 +72,24 @@ namespace snabel {
 
     const Sym name;
     Imps imps;
+    int64_t rev;
+    
     Func(const Sym &n);
   };
 
+  const size_t FUNC_CACHE_MAX(4);
+  
+  struct FuncCache {
+    struct Entry {
+      Func *fn;
+      int64_t rev, type_rev;
+      Types types;
+      FuncImp *imp;
+    };
+
+    std::vector<Entry> entries;
+  };
+
   Type *get_type(const FuncImp &imp, const ArgType &arg_type, const Args &args);
   opt<Args> match(const FuncImp &imp, Types types, Scope &scp, bool conv_args);
 
@@ -82,12 +98,16 @@ namespace snabel {
 					Scope &scp,
 					bool conv_args=false);
 
+  FuncImp *find_imp(FuncCache &cache, Func &fn, Scope &scp);
+  void cache_imp(FuncCache &cache, FuncImp &imp, const Args &args, Scope &scp);
+
   template <typename T>
   Func::ImpHandle add_imp(Func &fn,
 			  int sec,
 			  const ArgTypes &args,
 			  T imp) {
     fn.imps.emplace_front(fn, sec, args, imp);
+    fn.rev++;
     return fn.imps.begin();
   }
 }
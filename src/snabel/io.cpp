@@ -194,7 +194,7 @@ namespace snabel {
   }
   
   void init_io(Exec &exe){
-    exe.file_type.supers.push_back(&exe.ordered_type);
+    add_super(exe, exe.file_type, exe.ordered_type);
 
     exe.file_type.fmt = [](auto &v) {
       auto &f(*get<FileRef>(v));
@@ -209,8 +209,8 @@ namespace snabel {
       return get<FileRef>(x) < get<FileRef>(y);
     };
       
-    exe.rfile_type.supers.push_back(&exe.file_type);
-    exe.rfile_type.supers.push_back(&exe.readable_type);
+    add_super(exe, exe.rfile_type, exe.file_type);
+    add_super(exe, exe.rfile_type, exe.readable_type);
     exe.rfile_type.fmt = [](auto &v) {
       return fmt("RFile(%0)", get<FileRef>(v)->fd);
     };
@@ -233,8 +233,8 @@ namespace snabel {
       return READ_OK;
     };
 
-    exe.wfile_type.supers.push_back(&exe.file_type);
-    exe.wfile_type.supers.push_back(&exe.writeable_type);
+    add_super(exe, exe.wfile_type, exe.file_type);
+    add_super(exe, exe.wfile_type, exe.writeable_type);
 
     exe.wfile_type.fmt = [](auto &v) {
       return fmt("Wfile(%0)", get<FileRef>(v)->fd);
@@ -255,8 +255,8 @@ namespace snabel {
       return res;
     };
     
-    exe.rwfile_type.supers.push_back(&exe.file_type);
-    exe.rwfile_type.supers.push_back(&exe.writeable_type);
+    add_super(exe, exe.rwfile_type, exe.file_type);
+    add_super(exe, exe.rwfile_type, exe.writeable_type);
 
     exe.rwfile_type.fmt = [](auto &v) {
       return fmt("RWFile(%0)", get<FileRef>(v)->fd);
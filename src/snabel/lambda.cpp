@@ -4,14 +4,22 @@
 #include "snabel/thread.hpp"
 
 namespace snabel {
-  Lambda::Lambda(Label &lbl, Scope &scp):
+  Lambda::Lambda(Label &lbl, Scope &scp, const opt<Syms> &refs):
     label(lbl), safe_level(scp.safe_level)
   {
     for (auto s(scp.thread.scopes.rbegin());
 	 s != std::prev(scp.thread.scopes.rend()) &&
 	 s->safe_level == scp.safe_level;
 	 s++) {
-      std::copy(s->env.begin(), s->env.end(), std::inserter(env, env.end()));
+      if (!refs) {
+	merge_env(env, s->env);
+	continue;
+      }
+      
+      for (auto &r: *refs) {
+	auto fnd(find_env(s->env, r));
+	if (fnd && !find_env(env, r)) { put_env(env, r, *fnd); }
+      }
     }
   }
 
@@ -4,6 +4,7 @@
 #include "snabel/box.hpp"
 #include "snabel/env.hpp"
 #include "snabel/refs.hpp"
+#include "snackis/core/opt.hpp"
 
 namespace snabel {
   struct Label;
@@ -13,7 +14,7 @@ namespace snabel {
     Env env;
     int64_t safe_level;
     
-    Lambda(Label &lbl, Scope &scp);
+    Lambda(Label &lbl, Scope &scp, const opt<Syms> &refs);
   };
 
   bool call(const LambdaRef &lmb, Scope &scp, bool now);
@@ -150,7 +150,7 @@ namespace snabel {
   }
   
   void init_lists(Exec &exe) {
-    exe.list_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.list_type, exe.any_type);
     exe.list_type.args.push_back(&exe.any_type);
     exe.list_type.uneval = [](auto &v, auto &out) { uneval(*get<ListRef>(v), out); };
     exe.list_type.dump = [](auto &v) { return dump(*get<ListRef>(v)); };
@@ -214,9 +214,9 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &t(add_type(exe, n));
     t.raw = &exe.list_type;
-    t.supers.push_back(&exe.any_type);
-    t.supers.push_back(&get_iterable_type(exe, elt));
-    t.supers.push_back(&exe.list_type);
+    add_super(exe, t, exe.any_type);
+    add_super(exe, t, get_iterable_type(exe, elt));
+    add_super(exe, t, exe.list_type);
     t.args.push_back(&elt);
     t.dump = exe.list_type.dump;
     t.fmt = exe.list_type.fmt;
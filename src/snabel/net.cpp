@@ -131,7 +131,7 @@ namespace snabel {
   }
 
   void init_net(Exec &exe) {
-    exe.tcp_socket_type.supers.push_back(&exe.file_type);
+    add_super(exe, exe.tcp_socket_type, exe.file_type);
     
     exe.tcp_socket_type.fmt = [](auto &v) {
       return fmt("TCPSocket(%0)", get<FileRef>(v)->fd);
@@ -139,15 +139,15 @@ namespace snabel {
 
     exe.tcp_socket_type.eq = exe.file_type.eq;
     
-    exe.tcp_server_type.supers.push_back(&exe.tcp_socket_type);
+    add_super(exe, exe.tcp_server_type, exe.tcp_socket_type);
     exe.tcp_server_type.fmt = [](auto &v) {
       return fmt("TCPServer(%0)", get<FileRef>(v)->fd);
     };
     exe.tcp_server_type.eq = exe.file_type.eq;
     
-    exe.tcp_stream_type.supers.push_back(&exe.tcp_socket_type);
-    exe.tcp_stream_type.supers.push_back(&exe.readable_type);
-    exe.tcp_stream_type.supers.push_back(&exe.writeable_type);
+    add_super(exe, exe.tcp_stream_type, exe.tcp_socket_type);
+    add_super(exe, exe.tcp_stream_type, exe.readable_type);
+    add_super(exe, exe.tcp_stream_type, exe.writeable_type);
     exe.tcp_stream_type.read = exe.rwfile_type.read;
     exe.tcp_stream_type.write = exe.rwfile_type.write;
       
@@ -108,8 +108,7 @@ namespace snabel {
       auto &lmb(*thd.lambda);
       new_scp.safe_level = lmb.safe_level;
 	       
-      std::copy(lmb.env.begin(), lmb.env.end(),
-		std::inserter(scp.env, scp.env.end()));
+      merge_env(scp.env, lmb.env);
     }
 
     return true;
@@ -157,7 +156,7 @@ namespace snabel {
   }
 
   bool Capture::run(Scope &scp) {
-    push(scp, scp.exec.lambda_type, std::make_shared<Lambda>(target, scp));
+    push(scp, scp.exec.lambda_type, std::make_shared<Lambda>(target, scp, refs));
     return true;
   }
 
@@ -291,8 +290,11 @@ namespace snabel {
     }
 
     if (fnd->type == &scp.exec.func_type) {
-      TRY(try_call);
       auto &fn(*get<Func *>(*fnd));
+      auto imp(find_imp(cache, fn, scp));
+      if (imp) { return (*imp)(scp); }
+
+      TRY(try_call);
       auto m(match(fn, args, scp));
       
       if (!m) {
@@ -301,6 +303,7 @@ namespace snabel {
       }
 
       if (!try_call.errors.empty()) { return false; }
+      cache_imp(cache, *m->first, m->second, scp);
       return (*m->first)(scp, m->second);
     }
     
@@ -620,7 +623,7 @@ namespace snabel {
   { }
 
   Funcall::Funcall(Func &fn, const Types &args):
-    OpImp(OP_FUNCALL, "funcall"), fn(fn), imp(nullptr), args(args)
+    OpImp(OP_FUNCALL, "funcall"), fn(fn), args(args)
   { }
 
   OpImp &Funcall::get_imp(Op &op) const {
@@ -644,18 +647,11 @@ namespace snabel {
   }
   
   bool Funcall::run(Scope &scp) {
+    auto imp(find_imp(cache, fn, scp));
+    if (imp && (!scp.safe_level || imp->sec < Func::Unsafe)) { return (*imp)(scp); }
+    
     TRY(try_funcall);
     auto &thd(scp.thread);
-    
-    if (imp) {
-      auto m(match(*imp, args, scp, true));
-
-      if (m) {
-	(*imp)(scp, *m);
-	return true;
-      }
-    }
-
     auto m(match(fn, args, scp));
     
     if (!m) {
@@ -671,7 +667,8 @@ namespace snabel {
     }
 
     if (!try_funcall.errors.empty()) { return false; }
-    return(*imp)(scp, m->second);
+    cache_imp(cache, *imp, m->second, scp);
+    return (*imp)(scp, m->second);
   }
   
   Getenv::Getenv(opt<Sym> id):
@@ -1019,6 +1016,32 @@ namespace snabel {
     data(src.data), imp(src.imp.get_imp(*this)), prepared(src.prepared)
   { }
 
+  Instr::Instr(Op &op):
+    code(op.imp.code), imp(&op.imp), arg(0), val(nullptr), label(nullptr)
+  {
+    switch (code) {
+    case OP_BACKUP:
+      arg = std::get<Backup>(op.data).copy;
+      break;
+    case OP_DROP:
+      arg = std::get<Drop>(op.data).count;
+      break;
+    case OP_JUMP:
+      label = std::get<Jump>(op.data).label;
+      break;
+    case OP_PUSH: {
+      auto &vs(std::get<Push>(op.data).vals);
+      if (vs.size() == 1) { val = &vs.front(); }
+      break;
+    }
+    case OP_SWAP:
+      arg = std::get<Swap>(op.data).pos;
+      break;
+    default:
+      break;
+    }
+  }
+  
   bool prepare(Op &op, Scope &scp) {
     op.prepared = true;
     return op.imp.prepare(scp);
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "snabel/box.hpp"
+#include "snabel/env.hpp"
 #include "snabel/func.hpp"
 #include "snabel/label.hpp"
 #include "snabel/type.hpp"
@@ -84,6 +85,7 @@ namespace snabel {
 
   struct Capture: OpImp {
     Label &target;
+    opt<Syms> refs;
     
     Capture(Label &tgt);
     OpImp &get_imp(Op &op) const override;
@@ -112,6 +114,7 @@ namespace snabel {
   struct Deref: OpImp {
     Sym name;
     Types args;
+    FuncCache cache;
     bool compiled;
     
     Deref(const Sym &name);
@@ -183,8 +186,8 @@ namespace snabel {
 
   struct Funcall: OpImp {
     Func &fn;
-    FuncImp *imp;
     Types args;
+    FuncCache cache;
     
     Funcall(Func &fn, const Types &args={});
     OpImp &get_imp(Op &op) const override;
@@ -339,6 +342,18 @@ namespace snabel {
   Op::Op(const ImpT &imp): data(imp), imp(get<ImpT>(data)), prepared(false)
   { }
 
+  struct Instr {
+    OpCode code;
+    OpImp *imp;
+    int64_t arg;
+    const Box *val;
+    Label *label;
+
+    Instr(Op &op);
+  };
+
+  using Code = std::vector<Instr>;
+
   bool prepare(Op &op, Scope &scp);
   bool refresh(Op &op, Scope &scp);
   bool compile(Op &op, Scope &scp, OpSeq &out);
@@ -83,7 +83,7 @@ namespace snabel {
 
   
   void init_opts(Exec &exe) {
-    exe.opt_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.opt_type, exe.any_type);
     exe.opt_type.args.push_back(&exe.any_type);
 
     exe.opt_type.dump = [](auto &v) -> str {
@@ -148,8 +148,8 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &t(add_type(exe, n));
     t.raw = &exe.opt_type;
-    t.supers.push_back(&exe.any_type);
-    t.supers.push_back(&exe.opt_type);
+    add_super(exe, t, exe.any_type);
+    add_super(exe, t, exe.opt_type);
     t.args.push_back(&elt);
     t.fmt = exe.opt_type.fmt;
     t.dump = exe.opt_type.dump;
@@ -41,7 +41,7 @@ namespace snabel {
   }
 
   void init_pairs(Exec &exe) {
-    exe.pair_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.pair_type, exe.any_type);
     exe.pair_type.args.push_back(&exe.any_type);
     exe.pair_type.args.push_back(&exe.any_type);
     exe.pair_type.uneval = [](auto &v, auto &out) { uneval(get<Pair>(v), out); };
@@ -85,13 +85,13 @@ namespace snabel {
     
     auto &t(add_type(exe, n));
     t.raw = &exe.pair_type;
-    t.supers.push_back(&exe.any_type);
+    add_super(exe, t, exe.any_type);
 
     if (isa(thd, lt, exe.ordered_type) && isa(thd, rt, exe.ordered_type)) {
-      t.supers.push_back(&exe.ordered_type);
+      add_super(exe, t, exe.ordered_type);
     }
 
-    t.supers.push_back(&exe.pair_type);
+    add_super(exe, t, exe.pair_type);
     t.args.push_back(&lt);
     t.args.push_back(&rt);
 
@@ -42,7 +42,7 @@ namespace snabel {
   }
 
   void init_rats(Exec &exe) {
-    exe.rat_type.supers.push_back(&exe.num_type);
+    add_super(exe, exe.rat_type, exe.num_type);
 
     exe.rat_type.uneval = [](auto &v, auto &out) {
       auto &r(get<Rat>(v));
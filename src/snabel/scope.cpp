@@ -63,11 +63,11 @@ namespace snabel {
   }
 
   Box *find_env(Scope &scp, const Sym &key) {
-    auto fnd(scp.env.find(key));
+    auto fnd(find_env(scp.env, key));
     
-    if (fnd != scp.env.end() &&
-	(&scp == &scp.exec.main_scope || fnd->second.safe_level == scp.safe_level)) {
-      return &fnd->second;
+    if (fnd &&
+	(&scp == &scp.exec.main_scope || fnd->safe_level == scp.safe_level)) {
+      return fnd;
     }
 
     if (scp.parent) {
@@ -86,15 +86,7 @@ namespace snabel {
   }
 
   void put_env(Scope &scp, const Sym &key, const Box &val) {
-    auto fnd(scp.env.find(key));
-
-    if (fnd == scp.env.end()) {
-      scp.env.emplace(std::piecewise_construct,
-		      std::forward_as_tuple(key),
-		      std::forward_as_tuple(val));
-    } else {
-      fnd->second = val;
-    }
+    put_env(scp.env, key, val);
   }
 
   void put_env(Scope &scp, const str &key, const Box &val) {
@@ -102,8 +94,7 @@ namespace snabel {
   }
   
   bool rem_env(Scope &scp, const Sym &key) {
-    scp.env.erase(key);
-    return true;
+    return rem_env(scp.env, key);
   }
 
   bool rem_env(Scope &scp, const str &key) {
@@ -267,13 +258,10 @@ namespace snabel {
     auto &stk(curr_stack(thd));
     std::copy(stk.begin(), stk.end(), std::back_inserter(curr_stack(*t)));
     auto &te(t->main.env);
-    
-    for (auto &s: thd.scopes) {
-      auto &e(s.env);
-      std::copy(e.begin(), e.end(), std::inserter(te, te.end()));
-    }
+    for (auto &s: thd.scopes) { merge_env(te, s.env); }
     
     std::copy(thd.ops.begin(), thd.ops.end(), std::back_inserter(t->ops));
+    lower(*t, 0);
     t->pc = t->ops.size();
     
     if (init.type->call(curr_scope(*t), init, false)) {
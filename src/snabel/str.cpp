@@ -181,8 +181,8 @@ namespace snabel {
   }
   
   void init_strs(Exec &exe) {
-    exe.char_type.supers.push_back(&exe.any_type);
-    exe.char_type.supers.push_back(&exe.ordered_type);
+    add_super(exe, exe.char_type, exe.any_type);
+    add_super(exe, exe.char_type, exe.ordered_type);
 
     exe.char_type.dump = [](auto &v) -> str {
       auto c(get<char>(v));
@@ -203,8 +203,8 @@ namespace snabel {
     exe.char_type.eq = [](auto &x, auto &y) { return get<char>(x) == get<char>(y); };
     exe.char_type.lt = [](auto &x, auto &y) { return get<char>(x) < get<char>(y); };
     
-    exe.uchar_type.supers.push_back(&exe.any_type);
-    exe.uchar_type.supers.push_back(&exe.ordered_type);
+    add_super(exe, exe.uchar_type, exe.any_type);
+    add_super(exe, exe.uchar_type, exe.ordered_type);
     
     exe.uchar_type.dump = [](auto &v) -> str {
       auto c(get<uchar>(v));
@@ -233,9 +233,9 @@ namespace snabel {
       return get<uchar>(x) < get<uchar>(y);
     };
 
-    exe.str_type.supers.push_back(&exe.any_type);
-    exe.str_type.supers.push_back(&exe.ordered_type);
-    exe.str_type.supers.push_back(&get_iterable_type(exe, exe.char_type));
+    add_super(exe, exe.str_type, exe.any_type);
+    add_super(exe, exe.str_type, exe.ordered_type);
+    add_super(exe, exe.str_type, get_iterable_type(exe, exe.char_type));
     exe.str_type.fmt = [](auto &v) { return *get<StrRef>(v); };
     exe.str_type.dump = [](auto &v) { return fmt("'%0'", *get<StrRef>(v)); };
 
@@ -255,9 +255,9 @@ namespace snabel {
       return IterRef(new StrIter(exe, get<StrRef>(in)));
     };
 
-    exe.ustr_type.supers.push_back(&exe.any_type);
-    exe.ustr_type.supers.push_back(&exe.ordered_type);
-    exe.ustr_type.supers.push_back(&get_iterable_type(exe, exe.uchar_type));
+    add_super(exe, exe.ustr_type, exe.any_type);
+    add_super(exe, exe.ustr_type, exe.ordered_type);
+    add_super(exe, exe.ustr_type, get_iterable_type(exe, exe.uchar_type));
 
     exe.ustr_type.fmt = [](auto &v) {
       return fmt("\"%0\"", uconv.to_bytes(*get<UStrRef>(v)));
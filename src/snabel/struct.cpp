@@ -42,12 +42,12 @@ namespace snabel {
   }
   
   void init_structs(Exec &exe) {
-    exe.struct_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.struct_type, exe.any_type);
     auto &it_type(get_iterable_type(exe,
 				    get_pair_type(exe,
 						 exe.sym_type,
 						 exe.any_type)));
-    exe.struct_type.supers.push_back(&it_type);
+    add_super(exe, exe.struct_type, it_type);
     exe.struct_type.fmt = [](auto &v) { return fmt_arg(*get<StructRef>(v)); };
     
     exe.struct_type.eq = [](auto &x, auto &y) {
@@ -99,7 +99,7 @@ namespace snabel {
 	    break;
 	  }
 	    
-	  t.supers.push_back(st);
+	  add_super(exe, t, *st);
 	  continue;
 	}
 
@@ -168,7 +168,7 @@ namespace snabel {
 
   Type &add_struct_type(Exec &exe, const Sym &n) {
     auto &t(add_type(exe, n));
-    t.supers.push_back(&exe.struct_type);
+    add_super(exe, t, exe.struct_type);
     t.fmt = exe.struct_type.fmt;
     t.eq = exe.struct_type.eq;
     t.equal = exe.struct_type.equal;
@@ -18,8 +18,8 @@ namespace snabel {
   }
 
   void init_syms(Exec &exe) {
-    exe.sym_type.supers.push_back(&exe.any_type);
-    exe.sym_type.supers.push_back(&exe.ordered_type);
+    add_super(exe, exe.sym_type, exe.any_type);
+    add_super(exe, exe.sym_type, exe.ordered_type);
     exe.sym_type.uneval = [](auto &v, auto &out) { out << name(get<Sym>(v)); };
     exe.sym_type.fmt = [](auto &v) { return fmt("#%0", name(get<Sym>(v))); };
 
@@ -31,8 +31,8 @@ namespace snabel {
       return get<Sym>(x) < get<Sym>(y);
     };
 
-    exe.quote_type.supers.push_back(&exe.any_type);
-    exe.quote_type.supers.push_back(&exe.ordered_type);
+    add_super(exe, exe.quote_type, exe.any_type);
+    add_super(exe, exe.quote_type, exe.ordered_type);
     exe.quote_type.uneval = [](auto &v, auto &out) { out << *get<StrRef>(v); };
     exe.quote_type.fmt = [](auto &v) { return fmt("´%0", *get<StrRef>(v)); };
     exe.quote_type.eq = exe.str_type.eq;
@@ -117,7 +117,7 @@ namespace snabel {
   }
 
   void init_tables(Exec &exe) {
-    exe.table_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.table_type, exe.any_type);
     exe.table_type.args.push_back(&exe.any_type);
 
     exe.table_type.uneval = [](auto &v, auto &out) {
@@ -197,9 +197,9 @@ namespace snabel {
     if (fnd) { return *fnd; }
     auto &t(add_type(exe, n));
     t.raw = &exe.table_type;
-    t.supers.push_back(&exe.any_type);
-    t.supers.push_back(&get_iterable_type(exe, get_pair_type(exe, key, val)));
-    t.supers.push_back(&exe.table_type);
+    add_super(exe, t, exe.any_type);
+    add_super(exe, t, get_iterable_type(exe, get_pair_type(exe, key, val)));
+    add_super(exe, t, exe.table_type);
     t.args.push_back(&key);
     t.args.push_back(&val);
     t.dump = exe.table_type.dump;
@@ -261,6 +261,6 @@ namespace snabel {
   }
   
   bool nil(const Box &b) {
-    return !b.val.has_value();
+    return empty(b.val);
   }
 }
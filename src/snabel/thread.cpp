@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include "snackis/core/time.hpp"
 #include "snabel/error.hpp"
@@ -26,6 +27,7 @@ namespace snabel {
     id(id),
     pc(0),
     main(scopes.emplace_back(*this)),
+    isa_rev(-1),
     _stdin(std::make_shared<File>(*this, fileno(stdin), true)),
     _stdout(std::make_shared<File>(*this, fileno(stdout), true)),
     io_counter(0),
@@ -53,7 +55,7 @@ namespace snabel {
   }
 
   void init_threads(Exec &exe) {
-    exe.thread_type.supers.push_back(&exe.any_type);
+    add_super(exe, exe.thread_type, exe.any_type);
 
     exe.thread_type.fmt = [](auto &v) {
       return fmt("thread_%0", *get<Thread *>(v)->id);
@@ -186,6 +188,11 @@ namespace snabel {
     }
   }
   
+  size_t IsaHash::operator ()(const IsaKey &key) const {
+    std::hash<const Type *> h;
+    return h(key.first) * 31 + h(key.second);
+  }
+  
   bool isa(Thread &thd, const Types &x, const Types &y) {
     if (x.size() != y.size()) { return false; }
     auto i(x.begin()), j(y.begin());
@@ -196,6 +203,33 @@ namespace snabel {
     
     return i == x.end() && j == y.end();
   }
+
+  static bool find_isa(Thread &thd, const Type &x, const Type &y) {
+    if (x.raw == y.raw && isa(thd, x.args, y.args)) { return true; }
+
+    for (auto s: x.supers) {
+      if (isa(thd, *s, y)) { return true; }
+    }
+
+    return false;
+  }
+  
+  bool isa(Thread &thd, const Type &x, const Type &y) {
+    if (&x == &y) { return true; }
+    auto rev(thd.exec.type_rev.load());
+    
+    if (thd.isa_rev != rev) {
+      thd.isa_memo.clear();
+      thd.isa_rev = rev;
+    }
+
+    auto key(std::make_pair(&x, &y));
+    auto fnd(thd.isa_memo.find(key));
+    if (fnd != thd.isa_memo.end()) { return fnd->second; }
+    auto res(find_isa(thd, x, y));
+    thd.isa_memo.emplace(key, res);
+    return res;
+  }
     
   void start(Thread &thd) { thd.imp = std::thread(do_run, &thd); }
 
@@ -227,28 +261,139 @@ namespace snabel {
     return false;
   }
 
+  void lower(Thread &thd, int64_t start_pc) {
+    auto &code(thd.code);
+    code.erase(std::next(code.begin(), std::min<int64_t>(start_pc, code.size())),
+	       code.end());
+    
+    for (auto i(std::next(thd.ops.begin(), code.size()));
+	 i != thd.ops.end();
+	 i++) {
+      code.emplace_back(*i);
+    }
+  }
+
+#ifdef __GNUC__
+#define DISPATCH(code)				\
+  goto *dispatch[code]
+#else
+#define DISPATCH(code)				\
+  switch (code) {				\
+  case OP_BACKUP: goto backup;			\
+  case OP_DROP: goto drop;			\
+  case OP_DUP: goto dup;			\
+  case OP_JUMP: goto jump;			\
+  case OP_PUSH: goto push;			\
+  case OP_RESET: goto reset;			\
+  case OP_RESTORE: goto restore;		\
+  case OP_SWAP: goto swap;			\
+  default: goto generic;			\
+  }
+#endif
+  
   bool run(Thread &thd, int64_t break_pc) {
+#ifdef __GNUC__
+    static void *const dispatch[] = {
+      &&backup, &&generic, &&generic, &&generic, &&generic, &&generic,
+      &&generic, &&generic, &&drop, &&generic, &&dup, &&generic, &&generic,
+      &&generic, &&generic, &&generic, &&jump, &&generic, &&push, &&generic,
+      &&generic, &&reset, &&restore, &&generic, &&swap, &&generic, &&generic,
+      &&generic
+    };
+#endif
+    
     auto scope_depth(thd.scopes.size());
+    auto &code(thd.code);
+    const Instr *in(nullptr);
+    Scope *scp(nullptr);
+    int64_t prev_pc(-1);
+    
+  next:
+    if (thd.pc >= code.size() || thd.pc == break_pc) { return true; }
+    in = &code[thd.pc];
+    scp = &thd.scopes.back();
+    prev_pc = thd.pc;
+    DISPATCH(in->code);
+    
+  backup:
+    backup_stack(thd, in->arg);
+    thd.pc++;
+    goto next;
+    
+  drop: {
+      auto &s(curr_stack(thd));
+      if (s.size() < in->arg) { goto generic; }
+      s.erase(std::next(s.begin(), s.size()-in->arg), s.end());
+      thd.pc++;
+      goto next;
+    }
     
-    while (thd.pc < thd.ops.size() && thd.pc != break_pc) {
-      auto &op(thd.ops[thd.pc]);
-      auto prev_pc(thd.pc);
+  dup: {
+      auto &s(curr_stack(thd));
+      if (s.empty()) { goto generic; }
+      s.push_back(s.back());
+      thd.pc++;
+      goto next;
+    }
+    
+  jump: {
+      if (!in->label) { goto generic; }
+      auto &l(*in->label);
       
-      if (!run(op, curr_scope(thd))) {
-	while (thd.scopes.size() > scope_depth) {
-	  curr_scope(thd).push_result = false;
-	  end_scope(thd);
-	}
-	
-	curr_scope(thd).return_pc = -1;
-	return false;
+      if (l.return_depth || l.recall_depth || l.yield_depth || l.break_depth) {
+	jump(*scp, l);
+      } else {
+	thd.pc = l.pc;
       }
       
-      if (thd.pc == prev_pc) { thd.pc++; }
+      goto done;
     }
 
-    return true;
+  push: {
+      if (!in->val) { goto generic; }
+      auto &s(curr_stack(thd));
+      s.push_back(*in->val);
+      s.back().safe_level = scp->safe_level;
+      thd.pc++;
+      goto next;
+    }
+
+  reset:
+    curr_stack(thd).clear();
+    thd.pc++;
+    goto next;
+
+  restore:
+    restore_stack(*scp);
+    thd.pc++;
+    goto next;
+
+  swap: {
+      auto &s(curr_stack(thd));
+      if (s.size() < in->arg+1) { goto generic; }
+      auto i(std::next(s.begin(), s.size()-in->arg-1));
+      std::rotate(i, std::next(i), s.end());
+      thd.pc++;
+      goto next;
+    }
+    
+  generic:
+    if (!in->imp->run(*scp)) {
+      while (thd.scopes.size() > scope_depth) {
+	curr_scope(thd).push_result = false;
+	end_scope(thd);
+      }
+      
+      curr_scope(thd).return_pc = -1;
+      return false;
+    }
+
+  done:
+    if (thd.pc == prev_pc) { thd.pc++; }
+    goto next;
   }
+
+#undef DISPATCH
 }
 
 namespace snackis {
@@ -5,6 +5,8 @@
 #include <map>
 #include <random>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 
 #include <poll.h>
 
@@ -17,6 +19,13 @@ namespace snabel {
   const int POLL_MAX_FDS(10);
 
   using Threads = std::list<Thread>;
+  using IsaKey = std::pair<const Type *, const Type *>;
+
+  struct IsaHash {
+    size_t operator ()(const IsaKey &key) const;
+  };
+
+  using IsaMemo = std::unordered_map<IsaKey, bool, IsaHash>;
 
   struct Thread {
     using Id = std::thread::id;
@@ -27,13 +36,17 @@ namespace snabel {
     std::thread imp;
     PollQueue poll_queue;
     OpSeq ops;
+    Code code;
     int64_t pc;
     
-    std::deque<Scope> scopes;
     std::deque<Stack> stacks;
+    std::deque<Scope> scopes;
     Scope &main;
     LambdaRef lambda;
     
+    IsaMemo isa_memo;
+    int64_t isa_rev;
+    
     FileRef _stdin, _stdout;
     size_t io_counter;
     std::default_random_engine random;
@@ -62,23 +75,15 @@ namespace snabel {
   int64_t find_break_pc(Thread &thd);
   void idle(Thread &thd);
   bool isa(Thread &thd, const Types &x, const Types &y);
+  bool isa(Thread &thd, const Type &x, const Type &y);
 
   void start(Thread &thd);
   void join(Thread &thd, Scope &scp);
   bool _break(Thread &thd, int64_t depth);
+  void lower(Thread &thd, int64_t start_pc);
   bool run(Thread &thd, int64_t break_pc=-1); 
   
-  constexpr bool isa(Thread &thd, const Type &x, const Type &y) {
-    if (&x == &y || (x.raw == y.raw && isa(thd, x.args, y.args))) { return true; }
-
-    for (int64_t i(0); i < x.supers.size(); i++) {
-      if (isa(thd, *x.supers[i], y)) { return true; }
-    }
-
-    return false;
-  }
-
-  constexpr bool isa(Thread &thd, const Box &val, const Type &typ) {
+  inline bool isa(Thread &thd, const Box &val, const Type &typ) {
     return isa(thd, *val.type, typ);
   }
 }
@@ -0,0 +1,69 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "snabel/error.hpp"
+#include "snabel/exec.hpp"
+#include "snabel/thread.hpp"
+#include "snackis/core/error.hpp"
+#include "snackis/core/time.hpp"
+
+using namespace snabel;
+using namespace snackis;
+
+struct Bench {
+  str name, code;
+};
+
+const int REPS(10);
+
+const std::vector<Bench> benches {
+  {"sum", "0 100000 &+ for"},
+  {"stack", "0 100000 {$ $1 _ +} for"},
+  {"push", "0 100000 {1 2 3 + + + +} for"},
+  {"squares", "0 100000 {$ * +} for"},
+  {"mix", "0 100000 {7 * 3 - 2 + +} for"},
+  {"compare", "0 100000 {50000 lt? &++ when} for"},
+  {"isa", "let: l [1 2 3]; 0 100000 {_ @l Iterable<Num> is? &++ when} for"},
+  {"rat", "0 1 / 100000 {3 / +} for trunc"},
+  {"func", "func: sq $ *; 0 100000 {sq +} for"},
+  {"lambda", "let: sq {$ *}; 0 100000 {@sq call +} for"},
+  {"closure", "let: a 1; let: b 2; let: c 3; 0 100000 {{@a +} call +} for"}
+};
+
+static opt<Box> run_bench(Exec &exe, const str &code) {
+  reset(exe);
+  begin_scope(exe.main);
+  if (!compile(exe, code)) { return nullopt; }
+  run(exe.main);
+  return try_pop(exe.main);
+}
+
+int main() {
+  TRY(try_perf);
+  Exec exe;
+
+  std::cout << std::setw(10) << "bench"
+	    << std::setw(12) << "usecs"
+	    << "  result"
+	    << std::endl;
+
+  for (auto &b: benches) {
+    auto res(run_bench(exe, b.code));
+    int64_t best(-1);
+    
+    for (int i(0); i < REPS; i++) {
+      auto start(pnow());
+      run_bench(exe, b.code);
+      auto t(usecs(pnow()-start));
+      if (best == -1 || t < best) { best = t; }
+    }
+
+    std::cout << std::setw(10) << b.name
+	      << std::setw(12) << best
+	      << "  " << (res ? fmt_arg(*res) : "nil")
+	      << std::endl;
+  }
+
+  return 0;
+}
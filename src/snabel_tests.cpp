@@ -225,6 +225,12 @@ namespace snabel {
 	     "func: foo(x I64 y) @x 14 +; "
 	     "35 0 foo<Num>");
     CHECK(get<int64_t>(pop(exe.main)) == 42, _);    
+
+    run_test(exe,
+	     "func: foo(x I64) 1; "
+	     "func: foo(x Str) 2; "
+	     "0 [7 'bar' 7 'bar'] {foo +} for");
+    CHECK(get<int64_t>(pop(exe.main)) == 6, _);    
   }
 
   static void type_tests() {
@@ -252,6 +258,12 @@ namespace snabel {
 	     "conv: Foo Bar Bar new $ 42 set-b opt; "
 	     "Foo new Bar conv &b when");
     CHECK(get<int64_t>(pop(exe.main)) == 42, _);
+
+    auto &t(add_type(exe, "Baz"));
+    CHECK(!isa(exe.main, t, exe.num_type), _);
+    add_super(exe, t, exe.num_type);
+    CHECK(isa(exe.main, t, exe.num_type), _);
+    CHECK(isa(exe.main, get_list_type(exe, t), get_iterable_type(exe, exe.num_type)), _);
   }
 
   static void stack_tests() {
@@ -262,6 +274,10 @@ namespace snabel {
 
     run_test(exe, "7 35 |");
     CHECK(!peek(exe.main), _);
+
+    run_test(exe, "1 2 3 $ $2 _ _ -");
+    CHECK(get<int64_t>(pop(exe.main)) == -2, _);
+    CHECK(exe.main.code.size() == exe.main.ops.size(), _);
   }
 
   static void group_tests() {
@@ -274,6 +290,30 @@ namespace snabel {
     CHECK(get<int64_t>(*find_env(scp1, "@foo")) == 21, _);
   }
 
+  static void box_tests() {
+    TRY(try_test);
+    Scope &scp(exe.main_scope);
+    Box x(scp, exe.i64_type, (int64_t)42), y(x);
+    get<int64_t>(y)++;
+    CHECK(get<int64_t>(x) == 42, _);
+    CHECK(get<int64_t>(y) == 43, _);
+
+    Box p(scp, get_pair_type(exe, exe.i64_type, exe.i64_type), Pair(x, y));
+    Box q(p);
+    get<Pair>(q).first = y;
+    CHECK(get<int64_t>(get<Pair>(p).first) == 42, _);
+    CHECK(get<int64_t>(get<Pair>(q).first) == 43, _);
+    q = get<Pair>(q).first;
+    CHECK(get<int64_t>(q) == 43, _);
+    p = std::move(get<Pair>(p).second);
+    CHECK(get<int64_t>(p) == 43, _);
+
+    Box s(scp, exe.str_type, std::make_shared<str>("foo")), t(std::move(s));
+    CHECK(nil(s), _);
+    CHECK(*get<StrRef>(t) == "foo", _);
+    CHECK(nil(Box(scp, exe.i64_type)), _);
+  }
+
   static void equality_tests() {
     TRY(try_test);    
 
@@ -328,6 +368,22 @@ namespace snabel {
     CHECK(get<int64_t>(pop(exe.main)) == 42, _);
   }
 
+  static void capture_tests() {
+    TRY(try_test);
+
+    run_test(exe, "{let: foo 35; let: bar 7; {@foo}} call");
+    auto lmb(get<LambdaRef>(pop(exe.main)));
+    CHECK(lmb->env.size() == 1, _);
+    CHECK(find_env(lmb->env, get_sym(exe, "@foo")), _);
+
+    run_test(exe, "{let: foo 35; let: bar 7; {{@foo @bar +}}} call call call");
+    CHECK(get<int64_t>(pop(exe.main)) == 42, _);
+
+    run_test(exe, "{let: foo 35; let: bar 7; {\"@foo\" eval}} call");
+    lmb = get<LambdaRef>(pop(exe.main));
+    CHECK(lmb->env.size() == 2, _);
+  }
+
   static void coro_tests() {
     TRY(try_test);    
     
@@ -751,9 +807,11 @@ namespace snabel {
     type_tests();
     stack_tests();
     group_tests();
+    box_tests();
     equality_tests();
     let_tests();
     lambda_tests();
+    capture_tests();
     coro_tests();
     cond_tests();
     sym_tests();
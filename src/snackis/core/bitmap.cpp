@@ -0,0 +1,161 @@
+#include <algorithm>
+
+#include "snackis/core/bitmap.hpp"
+
+namespace snackis {
+  const size_t
+    BLOCK_WORDS(1 << 10),
+    BLOCK_SHRINK(BITMAP_ARRAY_MAX / 2);
+
+  Bitmap::Block::Block():
+    size(0)
+  { }
+
+  static void to_bits(Bitmap::Block &blk) {
+    blk.bits.assign(BLOCK_WORDS, 0);
+    for (auto v: blk.vals) { blk.bits[v >> 6] |= uint64_t(1) << (v & 63); }
+    blk.vals.clear();
+    blk.vals.shrink_to_fit();
+  }
+
+  static void to_vals(Bitmap::Block &blk) {
+    blk.vals.clear();
+    blk.vals.reserve(blk.size);
+
+    for (size_t i(0); i < blk.bits.size(); i++) {
+      for (uint64_t w(blk.bits[i]); w; w &= w-1) {
+	blk.vals.push_back(i*64 + __builtin_ctzll(w));
+      }
+    }
+
+    blk.bits.clear();
+    blk.bits.shrink_to_fit();
+  }
+
+  void set(Bitmap &bm, uint32_t val) {
+    auto &blk(bm.blocks[val >> 16]);
+    const uint16_t lo(val & 0xffff);
+
+    if (blk.bits.empty()) {
+      auto fnd(std::lower_bound(blk.vals.begin(), blk.vals.end(), lo));
+      if (fnd != blk.vals.end() && *fnd == lo) { return; }
+      blk.vals.insert(fnd, lo);
+      blk.size++;
+      if (blk.size > BITMAP_ARRAY_MAX) { to_bits(blk); }
+    } else {
+      auto &w(blk.bits[lo >> 6]);
+      const uint64_t m(uint64_t(1) << (lo & 63));
+      if (w & m) { return; }
+      w |= m;
+      blk.size++;
+    }
+  }
+
+  bool clear(Bitmap &bm, uint32_t val) {
+    auto fnd_blk(bm.blocks.find(val >> 16));
+    if (fnd_blk == bm.blocks.end()) { return false; }
+    auto &blk(fnd_blk->second);
+    const uint16_t lo(val & 0xffff);
+
+    if (blk.bits.empty()) {
+      auto fnd(std::lower_bound(blk.vals.begin(), blk.vals.end(), lo));
+      if (fnd == blk.vals.end() || *fnd != lo) { return false; }
+      blk.vals.erase(fnd);
+    } else {
+      auto &w(blk.bits[lo >> 6]);
+      const uint64_t m(uint64_t(1) << (lo & 63));
+      if (!(w & m)) { return false; }
+      w &= ~m;
+    }
+
+    blk.size--;
+
+    if (!blk.size) {
+      bm.blocks.erase(fnd_blk);
+    } else if (!blk.bits.empty() && blk.size < BLOCK_SHRINK) {
+      to_vals(blk);
+    }
+
+    return true;
+  }
+
+  bool test(const Bitmap &bm, uint32_t val) {
+    auto fnd(bm.blocks.find(val >> 16));
+    if (fnd == bm.blocks.end()) { return false; }
+    auto &blk(fnd->second);
+    const uint16_t lo(val & 0xffff);
+
+    if (blk.bits.empty()) {
+      return std::binary_search(blk.vals.begin(), blk.vals.end(), lo);
+    }
+
+    return blk.bits[lo >> 6] & (uint64_t(1) << (lo & 63));
+  }
+
+  size_t size(const Bitmap &bm) {
+    size_t out(0);
+    for (auto &b: bm.blocks) { out += b.second.size; }
+    return out;
+  }
+
+  bool empty(const Bitmap &bm) { return bm.blocks.empty(); }
+
+  static Bitmap::Block intersect(const Bitmap::Block &x,
+				 const Bitmap::Block &y) {
+    Bitmap::Block out;
+
+    if (x.bits.empty() && y.bits.empty()) {
+      std::set_intersection(x.vals.begin(), x.vals.end(),
+			    y.vals.begin(), y.vals.end(),
+			    std::back_inserter(out.vals));
+      out.size = out.vals.size();
+    } else if (x.bits.empty() || y.bits.empty()) {
+      auto &vs(x.bits.empty() ? x : y);
+      auto &bs(x.bits.empty() ? y : x);
+
+      for (auto v: vs.vals) {
+	if (bs.bits[v >> 6] & (uint64_t(1) << (v & 63))) { out.vals.push_back(v); }
+      }
+
+      out.size = out.vals.size();
+    } else {
+      out.bits.resize(BLOCK_WORDS);
+
+      for (size_t i(0); i < BLOCK_WORDS; i++) {
+	out.bits[i] = x.bits[i] & y.bits[i];
+	out.size += __builtin_popcountll(out.bits[i]);
+      }
+
+      if (out.size <= BITMAP_ARRAY_MAX) { to_vals(out); }
+    }
+
+    return out;
+  }
+
+  Bitmap intersect(const Bitmap &x, const Bitmap &y) {
+    Bitmap out;
+    auto xi(x.blocks.begin()), yi(y.blocks.begin());
+
+    while (xi != x.blocks.end() && yi != y.blocks.end()) {
+      if (xi->first < yi->first) {
+	xi++;
+      } else if (yi->first < xi->first) {
+	yi++;
+      } else {
+	auto blk(intersect(xi->second, yi->second));
+	if (blk.size) { out.blocks.emplace(xi->first, std::move(blk)); }
+	xi++;
+	yi++;
+      }
+    }
+
+    return out;
+  }
+
+  std::vector<uint32_t> get_vals(const Bitmap &bm) {
+    std::vector<uint32_t> out;
+    out.reserve(size(bm));
+    each(bm, [&out](auto v) { out.push_back(v); });
+    return out;
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef SNACKIS_BITMAP_HPP
+#define SNACKIS_BITMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace snackis {
+  const size_t BITMAP_ARRAY_MAX(4096);
+
+  struct Bitmap {
+    struct Block {
+      std::vector<uint16_t> vals;
+      std::vector<uint64_t> bits;
+      size_t size;
+
+      Block();
+    };
+
+    std::map<uint16_t, Block> blocks;
+  };
+
+  void set(Bitmap &bm, uint32_t val);
+  bool clear(Bitmap &bm, uint32_t val);
+  bool test(const Bitmap &bm, uint32_t val);
+  size_t size(const Bitmap &bm);
+  bool empty(const Bitmap &bm);
+  Bitmap intersect(const Bitmap &x, const Bitmap &y);
+  std::vector<uint32_t> get_vals(const Bitmap &bm);
+
+  template <typename FnT>
+  void each(const Bitmap &bm, FnT fn) {
+    for (auto &b: bm.blocks) {
+      const uint32_t hi(uint32_t(b.first) << 16);
+      auto &blk(b.second);
+
+      if (blk.bits.empty()) {
+	for (auto v: blk.vals) { fn(hi | v); }
+      } else {
+	for (size_t i(0); i < blk.bits.size(); i++) {
+	  for (uint64_t w(blk.bits[i]); w; w &= w-1) {
+	    fn(hi | uint32_t(i*64 + __builtin_ctzll(w)));
+	  }
+	}
+      }
+    }
+  }
+}
+
+#endif
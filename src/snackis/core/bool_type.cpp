@@ -15,6 +15,11 @@ namespace snackis {
     in.read((char *)&val, sizeof val);
     return val;
   }
+
+  bool BoolType::read(Buf &in) const {
+    auto data(take(in, 1));
+    return data && *data;
+  }
   
   void BoolType::write(const bool &val, std::ostream &out) const {
     const uint8_t out_val(val);
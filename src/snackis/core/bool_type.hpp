@@ -10,6 +10,7 @@ namespace snackis {
     bool from_val(const Val &in) const override;
     Val to_val(const bool &in) const override;
     bool read(std::istream &in) const override;
+    bool read(Buf &in) const override;
     void write(const bool &val, std::ostream &out) const override;
   };
 
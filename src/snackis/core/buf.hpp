@@ -0,0 +1,40 @@
+#ifndef SNACKIS_BUF_HPP
+#define SNACKIS_BUF_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace snackis {
+  struct Buf {
+    const char *const beg, *const end;
+    const char *pos;
+    bool fail, short_read;
+
+    Buf(const char *beg, const char *end);
+  };
+
+  inline Buf::Buf(const char *beg, const char *end):
+    beg(beg), end(end), pos(beg), fail(false), short_read(false)
+  { }
+
+  inline int64_t offset(const Buf &buf) { return buf.pos-buf.beg; }
+
+  inline bool eof(const Buf &buf) { return buf.fail || buf.pos == buf.end; }
+
+  inline const char *take(Buf &buf, size_t len) {
+    if (buf.fail) { return nullptr; }
+    
+    if (size_t(buf.end-buf.pos) < len) {
+      // Short reads consume the rest like istream eof, see db/slurp.hpp
+      buf.pos = buf.end;
+      buf.fail = buf.short_read = true;
+      return nullptr;
+    }
+
+    auto out(buf.pos);
+    buf.pos += len;
+    return out;
+  }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define SNACKIS_CHAN_HPP
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
@@ -38,16 +39,35 @@ namespace snackis {
     c.put_ok.notify_all();
   }
 
+  template <typename T>
+  bool is_closed(Chan<T> &c) {    
+    ChanLock lock(c.mutex);
+    return c.closed;
+  }
+
+  template <typename PredT>
+  void spin(PredT pred) {
+    int i(0);
+
+    do { 
+      std::this_thread::yield();
+      i++;
+    } while (pred() && i <= CHAN_RETRIES);
+  }
+
+  inline void notify(std::condition_variable &ok, size_t n) {
+    if (n == 1) {
+      ok.notify_one();
+    } else if (n > 1) {
+      ok.notify_all();
+    }
+  }
+  
   template <typename T>
   bool put(Chan<T> &c, const T &it, bool wait=true) {
     if (c.size.load() == c.max) {
       if (!wait) { return false; }
-      int i(0);
-
-      do { 
-	std::this_thread::yield();
-	i++;
-      } while (c.size.load() == c.max && i <= CHAN_RETRIES);
+      spin([&c]() { return c.size.load() == c.max; });
     }
     
     ChanLock lock(c.mutex);
@@ -68,12 +88,7 @@ namespace snackis {
   opt<T> get(Chan<T> &c, bool wait=true) {
     if (c.size.load() == 0) {
       if (!wait) { return nullopt; }
-      int i(0);
-
-      do { 
-	std::this_thread::yield(); 
-	i++;
-      } while (c.size.load() == 0 && i <= CHAN_RETRIES);
+      spin([&c]() { return c.size.load() == 0; });
     }
 
     ChanLock lock(c.mutex);
@@ -89,6 +104,81 @@ namespace snackis {
     c.put_ok.notify_one();
     return out;
   }
+
+  template <typename T, typename RangeT>
+  size_t put_all(Chan<T> &c, const RangeT &its, bool wait=true) {
+    ChanLock lock(c.mutex);
+    size_t n(0), pending(0);
+    
+    for (auto &it: its) {
+      if (wait && c.buf.size() == c.max) {
+	notify(c.get_ok, pending);
+	pending = 0;
+	c.put_ok.wait(lock, [&c](){ return c.closed || c.buf.size() < c.max; });
+      }
+      
+      if (c.closed || c.buf.size() == c.max) { break; }
+      c.buf.push_back(it);
+      c.size++;
+      n++;
+      pending++;
+    }
+
+    notify(c.get_ok, pending);
+    return n;
+  }
+
+  template <typename T, typename OutT>
+  size_t get_all(Chan<T> &c, OutT &out, size_t max, bool wait=true) {
+    if (c.size.load() == 0) {
+      if (!wait) { return 0; }
+      spin([&c]() { return c.size.load() == 0; });
+    }
+
+    ChanLock lock(c.mutex);
+    
+    if (wait && c.buf.empty()) {
+      c.get_ok.wait(lock, [&c](){ return c.closed || !c.buf.empty(); });
+    }
+
+    size_t n(0);
+    
+    for (; n < max && !c.buf.empty(); n++) {
+      out.push_back(c.buf.front());
+      c.buf.pop_front();
+      c.size--;
+    }
+
+    notify(c.put_ok, n);
+    return n;
+  }
+
+  template <typename T, typename OutT>
+  size_t get_all(Chan<T> &c, OutT &out, size_t max,
+		 std::chrono::microseconds timeout) {
+    ChanLock lock(c.mutex);
+    
+    if (c.buf.empty()) {
+      c.get_ok.wait_for(lock, timeout,
+			[&c](){ return c.closed || !c.buf.empty(); });
+    }
+
+    size_t n(0);
+    
+    for (; n < max && !c.buf.empty(); n++) {
+      out.push_back(c.buf.front());
+      c.buf.pop_front();
+      c.size--;
+    }
+
+    notify(c.put_ok, n);
+    return n;
+  }
+
+  template <typename T, typename OutT>
+  size_t drain(Chan<T> &c, OutT &out) {
+    return get_all(c, out, c.max, false);
+  }
 }
 
 #endif
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include "snackis/core/hist.hpp"
+
+namespace snackis {
+  Hist::Hist() {
+    clear(*this);
+  }
+
+  static size_t bucket(int64_t val) {
+    size_t i(0);
+    for (; val > 0 && i < HIST_BUCKETS-1; val >>= 1, i++);
+    return i;
+  }
+  
+  void add(Hist &h, int64_t val) {
+    if (val < 0) { val = 0; }
+    h.buckets[bucket(val)]++;
+    h.count++;
+    h.sum += val;
+    if (val > h.max) { h.max = val; }
+  }
+
+  void clear(Hist &h) {
+    h.buckets.fill(0);
+    h.count = h.sum = h.max = 0;
+  }
+  
+  int64_t percentile(const Hist &h, double p) {
+    const int64_t lim(h.count * p);
+    int64_t n(0);
+    
+    for (size_t i(0); i < HIST_BUCKETS; i++) {
+      n += h.buckets[i];
+      if (n > lim) { return std::min((int64_t(1) << i) - 1, h.max); }
+    }
+
+    return h.max;
+  }
+
+  template <>
+  str fmt_arg(const Hist &arg) {
+    return fmt("n %0, avg %1, p50 %2, p90 %3, p95 %4, p99 %5, max %6",
+	       arg.count,
+	       arg.count ? arg.sum / arg.count : 0,
+	       percentile(arg, 0.5),
+	       percentile(arg, 0.9),
+	       percentile(arg, 0.95),
+	       percentile(arg, 0.99),
+	       arg.max);
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef SNACKIS_HIST_HPP
+#define SNACKIS_HIST_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "snackis/core/fmt.hpp"
+#include "snackis/core/str.hpp"
+
+namespace snackis {
+  const size_t HIST_BUCKETS(64);
+
+  struct Hist {
+    std::array<int64_t, HIST_BUCKETS> buckets;
+    int64_t count, sum, max;
+
+    Hist();
+  };
+
+  void add(Hist &h, int64_t val);
+  void clear(Hist &h);
+  int64_t percentile(const Hist &h, double p);
+
+  template <>
+  str fmt_arg(const Hist &arg);
+}
+
+#endif
@@ -4,6 +4,13 @@
 namespace snackis {
   Int64Type int64_type;
 
+  const uint8_t INT64_BIN(0x80);
+
+  static int int64_bin_idx() {
+    static const int idx(std::ios_base::xalloc());
+    return idx;
+  }
+  
   Int64Type::Int64Type(): Type<int64_t>("Int64")
   { }
 
@@ -12,18 +19,69 @@ namespace snackis {
   Val Int64Type::to_val(const int64_t &in) const { return in; }
 
   int64_t Int64Type::read(std::istream &in) const {
-    uint8_t len;
+    uint8_t len(0);
     in.read((char *)&len, sizeof len);
-    std::vector<char> data(len);
-    in.read(&data[0], len);
-    const str str_val(data.begin(), data.end());
-    return to_int64(str_val);    
+
+    if (len & INT64_BIN) {
+      len &= ~INT64_BIN;
+
+      if (len > sizeof(uint64_t)) {
+	in.setstate(std::ios::failbit);
+	return 0;
+      }
+      
+      unsigned char data[sizeof(uint64_t)];
+      in.read((char *)data, len);
+      uint64_t val(0);
+      for (; len > 0; len--) { val = (val << 8) | data[len-1]; }
+      return (val >> 1) ^ -(val & 1);
+    }
+
+    char data[UINT8_MAX];
+    in.read(data, len);
+    return to_int64(str(data, len));    
+  }
+
+  int64_t Int64Type::read(Buf &in) const {
+    auto lp(take(in, 1));
+    if (!lp) { return 0; }
+    uint8_t len(*lp);
+
+    if (len & INT64_BIN) {
+      len &= ~INT64_BIN;
+
+      if (len > sizeof(uint64_t)) {
+	in.fail = true;
+	return 0;
+      }
+      
+      auto data((const unsigned char *)take(in, len));
+      if (!data) { return 0; }
+      uint64_t val(0);
+      for (; len > 0; len--) { val = (val << 8) | data[len-1]; }
+      return (val >> 1) ^ -(val & 1);
+    }
+
+    auto data(take(in, len));
+    return data ? to_int64(str(data, len)) : 0;
   }
   
   void Int64Type::write(const int64_t &val, std::ostream &out) const {
-    const str str_val(to_str(val));
-    uint8_t len(str_val.size());
-    out.write((char *)&len, sizeof len);
-    out.write(str_val.data(), len);
+    if (!out.iword(int64_bin_idx())) {
+      const str str_val(to_str(val));
+      uint8_t len(str_val.size());
+      out.write((char *)&len, sizeof len);
+      out.write(str_val.data(), len);
+      return;
+    }
+    
+    uint64_t zval((uint64_t(val) << 1) ^ uint64_t(val >> 63));
+    unsigned char data[sizeof(uint64_t)+1];
+    uint8_t len(0);
+    for (; zval; zval >>= 8) { data[++len] = zval & 0xff; }
+    data[0] = INT64_BIN | len;
+    out.write((char *)data, len+1);
   }
+
+  void set_int64_bin(std::ios_base &io) { io.iword(int64_bin_idx()) = 1; }
 }
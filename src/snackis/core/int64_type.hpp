@@ -10,10 +10,16 @@ namespace snackis {
     int64_t from_val(const Val &in) const override;
     Val to_val(const int64_t &in) const override;
     int64_t read(std::istream &in) const override;
+    int64_t read(Buf &in) const override;
     void write(const int64_t &val, std::ostream &out) const override;
   };
 
   extern Int64Type int64_type;
+
+  // Marks a stream as table log, Int64 values written to marked streams
+  // use the compact binary encoding; everything else, messages included,
+  // keeps the decimal format. Reading accepts both.
+  void set_int64_bin(std::ios_base &io);
 }
 
 #endif
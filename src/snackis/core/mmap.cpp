@@ -0,0 +1,40 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snackis/core/mmap.hpp"
+
+namespace snackis {
+  MMap::MMap(const Path &p):
+    data(nullptr), size(0), fail(true)
+  {
+    int fd(::open(p.string().c_str(), O_RDONLY));
+    if (fd == -1) { return; }
+    struct stat st;
+
+    if (fstat(fd, &st) == 0) {
+      size = st.st_size;
+      
+      if (size) {
+	void *m(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+
+	if (m != MAP_FAILED) {
+	  madvise(m, size, MADV_SEQUENTIAL);
+	  data = static_cast<const char *>(m);
+	  fail = false;
+	}
+      } else {
+	fail = false;
+      }
+    }
+
+    ::close(fd);
+  }
+
+  MMap::~MMap() {
+    if (data) { munmap(const_cast<char *>(data), size); }
+  }
+
+  Buf get_buf(const MMap &m) { return Buf(m.data, m.data+m.size); }
+}
@@ -0,0 +1,23 @@
+#ifndef SNACKIS_MMAP_HPP
+#define SNACKIS_MMAP_HPP
+
+#include <cstddef>
+
+#include "snackis/core/buf.hpp"
+#include "snackis/core/path.hpp"
+
+namespace snackis {
+  struct MMap {
+    const char *data;
+    size_t size;
+    bool fail;
+
+    MMap(const Path &p);
+    MMap(const MMap &) = delete;
+    ~MMap();
+  };
+
+  Buf get_buf(const MMap &m);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include "snackis/core/pool.hpp"
+
+namespace snackis {
+  static void run(Pool *p) {
+    while (true) {
+      auto job(get(p->jobs));
+      if (!job) { break; }
+      (*job)();
+    }
+  }
+
+  Pool::Pool(size_t size, size_t max_buf):
+    jobs(max_buf)
+  {
+    for (size_t i(0); i < size; i++) { threads.emplace_back(run, this); }
+  }
+
+  Pool::~Pool() {
+    close(jobs);
+    for (auto &t: threads) { t.join(); }
+  }
+
+  size_t default_pool_size() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  
+  bool post(Pool &p, const Job &job, bool wait) {
+    return put(p.jobs, job, wait);
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef SNACKIS_POOL_HPP
+#define SNACKIS_POOL_HPP
+
+#include <thread>
+#include <vector>
+
+#include "snackis/core/chan.hpp"
+#include "snackis/core/func.hpp"
+
+namespace snackis {
+  using Job = func<void ()>;
+  
+  struct Pool {
+    Chan<Job> jobs;
+    std::vector<std::thread> threads;
+
+    Pool(size_t size, size_t max_buf);
+    ~Pool();
+  };
+
+  size_t default_pool_size();
+  bool post(Pool &p, const Job &job, bool wait=true);
+}
+
+#endif
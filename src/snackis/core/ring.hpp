@@ -0,0 +1,247 @@
+#ifndef SNACKIS_RING_HPP
+#define SNACKIS_RING_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "snackis/core/chan.hpp"
+#include "snackis/core/error.hpp"
+#include "snackis/core/opt.hpp"
+
+namespace snackis {
+  template <typename T>
+  struct Ring {
+    struct Cell {
+      std::atomic<size_t> seq;
+      opt<T> val;
+    };
+
+    const size_t max, mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> put_pos;
+    alignas(64) std::atomic<size_t> get_pos;
+    alignas(64) std::atomic<int> putting, put_waits, get_waits;
+    std::atomic<bool> closed;
+    std::mutex mutex;
+    std::condition_variable get_ok, put_ok;
+
+    Ring(size_t max);
+  };
+
+  const int RING_SPINS(64);
+
+  inline size_t ring_size(size_t max) {
+    size_t out(2);
+    while (out < max) { out *= 2; }
+    return out;
+  }
+
+  template <typename T>
+  Ring<T>::Ring(size_t max):
+    max(ring_size(max)),
+    mask(this->max-1),
+    cells(new Cell[this->max]),
+    put_pos(0), get_pos(0),
+    putting(0), put_waits(0), get_waits(0),
+    closed(false)
+  {
+    for (size_t i(0); i < this->max; i++) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  template <typename T>
+  bool try_put(Ring<T> &r, const T &it) {
+    auto pos(r.put_pos.load(std::memory_order_relaxed));
+
+    while (true) {
+      auto &c(r.cells[pos & r.mask]);
+      auto seq(c.seq.load(std::memory_order_acquire));
+      auto dif(intptr_t(seq) - intptr_t(pos));
+
+      if (dif == 0) {
+	if (r.put_pos.compare_exchange_weak(pos, pos+1,
+					    std::memory_order_relaxed)) {
+	  c.val.emplace(it);
+	  c.seq.store(pos+1, std::memory_order_release);
+	  return true;
+	}
+      } else if (dif < 0) {
+	return false;
+      } else {
+	pos = r.put_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  template <typename T>
+  opt<T> try_get(Ring<T> &r) {
+    auto pos(r.get_pos.load(std::memory_order_relaxed));
+
+    while (true) {
+      auto &c(r.cells[pos & r.mask]);
+      auto seq(c.seq.load(std::memory_order_acquire));
+      auto dif(intptr_t(seq) - intptr_t(pos+1));
+
+      if (dif == 0) {
+	if (r.get_pos.compare_exchange_weak(pos, pos+1,
+					    std::memory_order_relaxed)) {
+	  opt<T> out(std::move(*c.val));
+	  c.val.reset();
+	  c.seq.store(pos+r.mask+1, std::memory_order_release);
+	  return out;
+	}
+      } else if (dif < 0) {
+	return nullopt;
+      } else {
+	pos = r.get_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  template <typename T>
+  void wake(Ring<T> &r,
+	    std::atomic<int> &waits, std::condition_variable &ok,
+	    size_t n=1) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (n && waits.load()) {
+      ChanLock lock(r.mutex);
+      notify(ok, n);
+    }
+  }
+
+  template <typename T, typename PredT>
+  void park(Ring<T> &r,
+	    std::atomic<int> &waits, std::condition_variable &ok,
+	    PredT pred) {
+    ChanLock lock(r.mutex);
+    waits++;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ok.wait(lock, pred);
+    waits--;
+  }
+
+  template <typename T>
+  void close(Ring<T> &r) {
+    ChanLock lock(r.mutex);
+    CHECK(r.closed.load(), !_);
+    r.closed.store(true);
+    r.get_ok.notify_all();
+    r.put_ok.notify_all();
+  }
+
+  template <typename T>
+  void end_put(Ring<T> &r) {
+    if (--r.putting == 0 && r.closed.load()) {
+      ChanLock lock(r.mutex);
+      r.get_ok.notify_all();
+    }
+  }
+
+  template <typename T>
+  bool put(Ring<T> &r, const T &it, bool wait=true) {
+    r.putting++;
+    bool ok(!r.closed.load() && try_put(r, it));
+
+    if (!ok && wait) {
+      for (int i(0); !ok && !r.closed.load() && i < RING_SPINS+CHAN_RETRIES;
+	   i++) {
+	if (i >= RING_SPINS) { std::this_thread::yield(); }
+	ok = try_put(r, it);
+      }
+
+      if (!ok) {
+	park(r, r.put_waits, r.put_ok, [&r, &it, &ok]() {
+	    return r.closed.load() || (ok = try_put(r, it));
+	  });
+      }
+    }
+
+    if (ok) { wake(r, r.get_waits, r.get_ok); }
+    end_put(r);
+    return ok;
+  }
+
+  template <typename T>
+  bool drained(Ring<T> &r) {
+    return r.closed.load() && r.putting.load() == 0;
+  }
+
+  template <typename T>
+  opt<T> get(Ring<T> &r, bool wait=true) {
+    auto out(try_get(r));
+
+    if (!out && wait) {
+      for (int i(0); !out && i < RING_SPINS+CHAN_RETRIES; i++) {
+	if (drained(r)) { break; }
+	if (i >= RING_SPINS) { std::this_thread::yield(); }
+	out = try_get(r);
+      }
+
+      if (!out) {
+	park(r, r.get_waits, r.get_ok, [&r, &out]() {
+	    return drained(r) || (out = try_get(r));
+	  });
+      }
+    }
+
+    if (!out && drained(r)) { out = try_get(r); }
+    if (out) { wake(r, r.put_waits, r.put_ok); }
+    return out;
+  }
+
+  template <typename T, typename RangeT>
+  size_t put_all(Ring<T> &r, const RangeT &its, bool wait=true) {
+    size_t n(0), pending(0);
+    r.putting++;
+    
+    for (auto &it: its) {
+      if (r.closed.load()) { break; }
+      
+      if (try_put(r, it)) {
+	n++;
+	pending++;
+	continue;
+      }
+
+      wake(r, r.get_waits, r.get_ok, pending);
+      pending = 0;
+      if (!wait || !put(r, it)) { break; }
+      n++;
+    }
+
+    wake(r, r.get_waits, r.get_ok, pending);
+    end_put(r);
+    return n;
+  }
+
+  template <typename T, typename OutT>
+  size_t get_all(Ring<T> &r, OutT &out, size_t max, bool wait=true) {
+    if (!max) { return 0; }
+    auto first(get(r, wait));
+    if (!first) { return 0; }
+    out.push_back(std::move(*first));
+    size_t n(1);
+    
+    for (; n < max; n++) {
+      auto it(try_get(r));
+      if (!it) { break; }
+      out.push_back(std::move(*it));
+    }
+
+    wake(r, r.put_waits, r.put_ok, n-1);
+    return n;
+  }
+
+  template <typename T, typename OutT>
+  size_t drain(Ring<T> &r, OutT &out) {
+    return get_all(r, out, r.max, false);
+  }
+}
+
+#endif
@@ -15,6 +15,7 @@ namespace snackis {
     std::set<ValT> from_val(const Val &in) const override;
     Val to_val(const std::set<ValT> &in) const override;
     std::set<ValT> read(std::istream &in) const override;
+    std::set<ValT> read(Buf &in) const override;
     void write(const std::set<ValT> &val, std::ostream &out) const override;
   };
 
@@ -51,6 +52,18 @@ namespace snackis {
     for (size_t i = 0; i < len; i++) { out.insert(val_type.read(in)); }
     return out;
   }
+
+  template <typename ValT>
+  std::set<ValT> SetType<ValT>::read(Buf &in) const {
+    int64_t len(int64_type.read(in));
+    std::set<ValT> out;
+    
+    for (int64_t i = 0; i < len && !in.fail; i++) {
+      out.insert(val_type.read(in));
+    }
+    
+    return out;
+  }
   
   template <typename ValT>
   void SetType<ValT>::write(const std::set<ValT> &in,
@@ -4,6 +4,7 @@
 #include <codecvt>
 #include <set>
 #include <string>
+#include <string_view>
 
 #include "snackis/core/char.hpp"
 #include "snackis/core/data.hpp"
@@ -12,6 +13,7 @@
 
 namespace snackis {
   using str = std::string;
+  using str_view = std::string_view;
   using ustr = std::u16string;
   extern const str whitespace;
   extern std::wstring_convert<std::codecvt_utf8_utf16<uchar>, uchar> uconv;
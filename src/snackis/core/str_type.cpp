@@ -16,9 +16,18 @@ namespace snackis {
   str StrType::read(std::istream &in) const {
     int64_t len(int64_type.read(in));
     if (!len) { return ""; }
-    std::vector<char> data(len);
-    in.read(&data[0], len);
-    return str(data.begin(), data.end());
+    str out(len, 0);
+    in.read(&out[0], len);
+    return out;
+  }
+
+  str StrType::read(Buf &in) const { return str(read_view(in)); }
+
+  str_view StrType::read_view(Buf &in) const {
+    int64_t len(int64_type.read(in));
+    if (len <= 0) { return str_view(); }
+    auto data(take(in, len));
+    return data ? str_view(data, len) : str_view();
   }
   
   void StrType::write(const str &val, std::ostream &out) const {
@@ -11,6 +11,8 @@ namespace snackis {
     str from_val(const Val &in) const override;
     Val to_val(const str &in) const override;
     str read(std::istream &in) const override;
+    str read(Buf &in) const override;
+    str_view read_view(Buf &in) const;
     void write(const str &val, std::ostream &out) const override;
   };
 
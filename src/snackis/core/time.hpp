@@ -27,6 +27,11 @@ namespace snackis {
   auto usecs(std::chrono::duration<Args...> d) {
     return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
   }
+
+  template <typename...Args>
+  auto nsecs(std::chrono::duration<Args...> d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
 };
 
 #endif
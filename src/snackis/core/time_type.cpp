@@ -16,6 +16,11 @@ namespace snackis {
     int64_t ms(int64_type.read(in));
     return Time(std::chrono::milliseconds(ms));
   }
+
+  Time TimeType::read(Buf &in) const {
+    int64_t ms(int64_type.read(in));
+    return Time(std::chrono::milliseconds(ms));
+  }
   
   void TimeType::write(const Time &val, std::ostream &out) const {
     auto epoch = val.time_since_epoch();
@@ -11,6 +11,7 @@ namespace snackis {
     Time from_val(const Val &in) const override;
     Val to_val(const Time &in) const override;
     Time read(std::istream &in) const override;
+    Time read(Buf &in) const override;
     void write(const Time &val, std::ostream &out) const override;
   };
 
@@ -1,6 +1,7 @@
 #ifndef SNACKIS_TUPLE_HPP
 #define SNACKIS_TUPLE_HPP
 
+#include <algorithm>
 #include <tuple>
 
 namespace snackis {
@@ -15,6 +16,28 @@ namespace snackis {
 	return std::make_tuple(f(args)...);
       }, t);
   }
+
+  template <size_t I=0, typename...X, typename...Y>
+  int compare_prefix(const std::tuple<X...> &x, const std::tuple<Y...> &y) {
+    if constexpr (I == std::min(sizeof...(X), sizeof...(Y))) {
+      return 0;
+    } else {
+      auto &xv(std::get<I>(x));
+      auto &yv(std::get<I>(y));
+      if (xv < yv) { return -1; }
+      if (yv < xv) { return 1; }
+      return compare_prefix<I+1>(x, y);
+    }
+  }
+
+  struct PrefixLess {
+    using is_transparent = void;
+    
+    template <typename...X, typename...Y>
+    bool operator ()(const std::tuple<X...> &x, const std::tuple<Y...> &y) const {
+      return compare_prefix(x, y) < 0;
+    }
+  };
 }
 
 #endif
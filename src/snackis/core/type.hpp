@@ -3,6 +3,7 @@
 
 #include <iostream>
 
+#include "snackis/core/buf.hpp"
 #include "snackis/core/str.hpp"
 #include "snackis/core/val.hpp"
 
@@ -11,6 +12,7 @@ namespace snackis {
     const str name; 
     BasicType(const str &name);
     virtual Val read_val(std::istream &in) const = 0;
+    virtual Val read_val(Buf &in) const = 0;
     virtual void write_val(const Val &val, std::ostream &out) const = 0;
   };
 
@@ -23,8 +25,10 @@ namespace snackis {
     virtual ValT from_val(const Val &in) const = 0;
     virtual Val to_val(const ValT &in) const = 0;
     Val read_val(std::istream &in) const override;
+    Val read_val(Buf &in) const override;
     void write_val(const Val &val, std::ostream &out) const override;
     virtual ValT read(std::istream &in) const = 0;
+    virtual ValT read(Buf &in) const = 0;
     virtual void write(const ValT &val, std::ostream &out) const = 0;
   };
 
@@ -44,6 +48,11 @@ namespace snackis {
     return to_val(read(in));
   }
   
+  template <typename ValT>
+  Val Type<ValT>::read_val(Buf &in) const {
+    return to_val(read(in));
+  }
+
   template <typename ValT>
   void Type<ValT>::write_val(const Val &val, std::ostream &out) const {
     write(from_val(val), out);
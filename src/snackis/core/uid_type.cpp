@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "snackis/core/uid_type.hpp"
 
 namespace snackis {
@@ -17,6 +19,13 @@ namespace snackis {
     in.read(reinterpret_cast<char *>(id.val), sizeof(id.val));
     return id;
   }
+
+  UId UIdType::read(Buf &in) const {
+    UId id(false);
+    auto data(take(in, sizeof(id.val)));
+    if (data) { memcpy(id.val, data, sizeof(id.val)); }
+    return id;
+  }
   
   void UIdType::write(const UId &id, std::ostream &out) const {
     out.write(reinterpret_cast<const char *>(id.val), sizeof(id.val));
@@ -12,6 +12,7 @@ namespace snackis {
     UId from_val(const Val &in) const override;
     Val to_val(const UId &in) const override;
     UId read(std::istream &in) const override;
+    UId read(Buf &in) const override;
     void write(const UId &val, std::ostream &out) const override;
   };
 
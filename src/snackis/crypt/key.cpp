@@ -19,6 +19,16 @@ namespace crypt {
     in.read((char *)data, sizeof data);
   }
 
+  Key::Key(Buf &in) {
+    auto src(take(in, sizeof data));
+
+    if (src) {
+      memcpy(data, src, sizeof data);
+    } else {
+      memset(data, 0, sizeof data);
+    }
+  }
+
   bool operator ==(const Key &x, const Key &y) {
     return x.data == y.data;
   }
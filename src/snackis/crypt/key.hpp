@@ -11,6 +11,7 @@ namespace crypt {
     Key();
     Key(PubKey &pub);
     Key(std::istream &in);
+    Key(Buf &in);
   };  
 
   extern const Key null_key;
@@ -16,6 +16,10 @@ namespace crypt {
   Key KeyType::read(std::istream &in) const {
     return Key(in);
   }
+
+  Key KeyType::read(Buf &in) const {
+    return Key(in);
+  }
   
   void KeyType::write(const Key &val, std::ostream &out) const {
     out.write((const char *)val.data, sizeof val.data);
@@ -13,6 +13,7 @@ namespace crypt {
     Key from_val(const Val &in) const override;
     Val to_val(const Key &in) const override;
     Key read(std::istream &in) const override;
+    Key read(Buf &in) const override;
     void write(const Key &val, std::ostream &out) const override;
   };
 
@@ -15,6 +15,16 @@ namespace crypt {
     in.read((char *)data, sizeof data);
   }
 
+  PubKey::PubKey(Buf &in) {
+    auto src(take(in, sizeof data));
+
+    if (src) {
+      memcpy(data, src, sizeof data);
+    } else {
+      memset(data, 0, sizeof data);
+    }
+  }
+
   bool operator ==(const PubKey &x, const PubKey &y) {
     return x.data == y.data;
   }
@@ -4,6 +4,8 @@
 #include <sodium.h>
 #include <istream>
 
+#include "snackis/core/buf.hpp"
+
 namespace snackis {
 namespace crypt {
   struct Key;
@@ -12,6 +14,7 @@ namespace crypt {
     unsigned char data[crypto_box_PUBLICKEYBYTES];
     PubKey();
     PubKey(std::istream &in);
+    PubKey(Buf &in);
   };
 
   extern const PubKey null_pub_key;
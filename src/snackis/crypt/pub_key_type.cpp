@@ -16,6 +16,10 @@ namespace crypt {
   PubKey PubKeyType::read(std::istream &in) const {
     return PubKey(in);
   }
+
+  PubKey PubKeyType::read(Buf &in) const {
+    return PubKey(in);
+  }
   
   void PubKeyType::write(const PubKey &val, std::ostream &out) const {
     out.write((const char *)val.data, sizeof val.data);
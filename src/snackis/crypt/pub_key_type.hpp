@@ -13,6 +13,7 @@ namespace crypt {
     PubKey from_val(const Val &in) const override;
     Val to_val(const PubKey &in) const override;
     PubKey read(std::istream &in) const override;
+    PubKey read(Buf &in) const override;
     void write(const PubKey &val, std::ostream &out) const override;
   };
 
@@ -6,6 +6,8 @@ namespace snackis {
 namespace crypt {
   Secret::Secret() { memset(data, 0, SIZE); }
 
+  Nonce::Nonce() { randombytes_buf(data, Secret::NONCE_SIZE); }
+
   void init_salt(Secret &sec) {
     randombytes_buf(sec.data, Secret::SALT_SIZE);
   }
@@ -25,11 +27,16 @@ namespace crypt {
     return sec.data + Secret::SALT_SIZE;
   }
   
-  Data encrypt(const Secret &sec, const unsigned char *in, size_t len) {
+  void next(Nonce &nonce) {
+    sodium_increment(nonce.data, Secret::NONCE_SIZE);
+  }
+  
+  Data encrypt(const Secret &sec, const Nonce &nonce,
+	       const unsigned char *in, size_t len) {
     Data out;
     const size_t DATA_SIZE = crypto_aead_chacha20poly1305_IETF_ABYTES+len;
     out.resize(Secret::NONCE_SIZE+DATA_SIZE, 0);
-    randombytes_buf(&out[0], Secret::NONCE_SIZE);
+    memcpy(&out[0], nonce.data, Secret::NONCE_SIZE);
 
     unsigned long long clen;
     crypto_aead_chacha20poly1305_ietf_encrypt(&out[Secret::NONCE_SIZE], &clen,
@@ -40,8 +47,18 @@ namespace crypt {
     return out;
   }
 
+  Data encrypt(const Secret &sec, const unsigned char *in, size_t len) {
+    return encrypt(sec, Nonce(), in, len);
+  }
+
   Data decrypt(const Secret &secret, const unsigned char *in, size_t len) {
     Data out;
+
+    if (len < Secret::NONCE_SIZE+crypto_aead_chacha20poly1305_IETF_ABYTES) {
+      ERROR(Crypt, "Invalid secret message");
+      return out;
+    }
+    
     out.resize(len-Secret::NONCE_SIZE-crypto_aead_chacha20poly1305_IETF_ABYTES);
 
     unsigned long long dlen;
@@ -20,9 +20,19 @@ namespace crypt {
     Secret();
   };
 
+  struct Nonce {
+    unsigned char data[Secret::NONCE_SIZE];
+
+    Nonce();
+  };
+
   void init_salt(Secret &sec);
   void init(Secret &sec, const str &key);
   const unsigned char *hash(const Secret &sec);
+  void next(Nonce &nonce);
+
+  Data encrypt(const Secret &secret, const Nonce &nonce,
+	       const unsigned char *in, size_t len);
 
   Data encrypt(const Secret &secret, const unsigned char *in, size_t len);
   Data decrypt(const Secret &secret, const unsigned char *in, size_t len);
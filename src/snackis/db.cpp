@@ -13,14 +13,33 @@ namespace snackis {
   static void init_indexes(Db &db) {
     db.peers.indexes.insert(&db.peers_sort);
     db.scripts.indexes.insert(&db.scripts_sort);
+    db.scripts.indexes.insert(&db.scripts_text);
+    db.scripts.indexes.insert(&db.scripts_tags);
     db.feeds.indexes.insert(&db.feeds_sort);
+    db.feeds.indexes.insert(&db.feeds_tags);
     db.posts.indexes.insert(&db.posts_sort);
     db.posts.indexes.insert(&db.feed_posts);
+    db.posts.indexes.insert(&db.posts_text);
+    db.posts.indexes.insert(&db.posts_tags);
     db.inbox.indexes.insert(&db.inbox_sort);
     db.projects.indexes.insert(&db.projects_sort);
+    db.projects.indexes.insert(&db.projects_tags);
     db.tasks.indexes.insert(&db.tasks_sort);
+    db.tasks.indexes.insert(&db.tasks_text);
+    db.tasks.indexes.insert(&db.tasks_tags);
   }
 
+  void drop_search_indexes(Db &db) {
+    db.scripts.indexes.erase(&db.scripts_text);
+    db.scripts.indexes.erase(&db.scripts_tags);
+    db.feeds.indexes.erase(&db.feeds_tags);
+    db.posts.indexes.erase(&db.posts_text);
+    db.posts.indexes.erase(&db.posts_tags);
+    db.projects.indexes.erase(&db.projects_tags);
+    db.tasks.indexes.erase(&db.tasks_text);
+    db.tasks.indexes.erase(&db.tasks_tags);
+  }
+  
   static void init_events(Db &db, Ctx &ctx) {
     db.peers.on_update.push_back([&](auto &prev_rec, auto &curr_rec) {
 	db::set(curr_rec, peer_changed_at, now());
@@ -148,32 +167,46 @@ namespace snackis {
 	  {&peer_created_at, &peer_changed_at, &peer_name, &peer_email, &peer_info,
 	      &peer_tags, &peer_crypt_key, &peer_active}),
 
-    peers_sort(ctx, "peers_sort", db::make_key(peer_name, peer_id), {}),
+    peers_sort(ctx, "peers_sort", db::make_key(peer_name, peer_id)),
     
     scripts(ctx, "scripts", script_key, script_cols),
 
     scripts_sort(ctx, "scripts_sort",
-		 db::make_key(script_name, script_created_at, script_id),
-		 {}),
+		 db::make_key(script_name, script_created_at, script_id)),
+
+    scripts_docs(db::make_key(script_id)),
+
+    scripts_text(ctx, "scripts_text", scripts_docs, {&script_code}),
+
+    scripts_tags(ctx, "scripts_tags", scripts_docs, script_tags),
 
     scripts_share({&script_id, &script_created_at, &script_changed_at, &script_name,
 	  &script_code, &script_peer_ids}),
 
     feeds(ctx, "feeds", feed_key, feed_cols),
 
-    feeds_sort(ctx, "feeds_sort", db::make_key(feed_created_at, feed_id), {}),
+    feeds_sort(ctx, "feeds_sort", db::make_key(feed_created_at, feed_id)),
+
+    feeds_docs(db::make_key(feed_id)),
+
+    feeds_tags(ctx, "feeds_tags", feeds_docs, feed_tags),
 
     feeds_share({&feed_id, &feed_created_at, &feed_changed_at, &feed_name,
 	  &feed_info, &feed_active, &feed_visible, &feed_peer_ids}),
     
     posts(ctx, "posts", post_key, post_cols),
 
-    posts_sort(ctx, "posts_sort", db::make_key(post_created_at, post_id), {}),
+    posts_sort(ctx, "posts_sort", db::make_key(post_created_at, post_id)),
 
     feed_posts(ctx,
 	       "feed_posts",
-	       db::make_key(post_feed_id, post_created_at, post_id),
-	       {}),
+	       db::make_key(post_feed_id, post_created_at, post_id)),
+
+    posts_docs(db::make_key(post_id)),
+
+    posts_text(ctx, "posts_text", posts_docs, {&post_body}),
+
+    posts_tags(ctx, "posts_tags", posts_docs, post_tags),
 
     posts_share({&post_id, &post_feed_id, &post_created_at, &post_changed_at,
 	  &post_body, &post_peer_ids}),
@@ -188,19 +221,28 @@ namespace snackis {
 	       &msg_crypt_key, &msg_script, &msg_feed, &msg_post, &msg_project,
 	       &msg_task}),
 
-    inbox_sort(ctx, "inbox_sort", db::make_key(msg_fetched_at, msg_id), {}),
+    inbox_sort(ctx, "inbox_sort", db::make_key(msg_fetched_at, msg_id)),
 
     projects(ctx, "projects", project_key, project_cols),
 
-    projects_sort(ctx, "projects_sort", db::make_key(project_name, project_id), {}),
+    projects_sort(ctx, "projects_sort", db::make_key(project_name, project_id)),
+
+    projects_docs(db::make_key(project_id)),
+
+    projects_tags(ctx, "projects_tags", projects_docs, project_tags),
 
     projects_share({&project_id, &project_created_at, &project_changed_at,
 	  &project_name, &project_info, &project_active, &project_peer_ids}),
     
     tasks(ctx, "tasks", task_key, task_cols),
 
-    tasks_sort(ctx, "tasks_sort", db::make_key(task_prio, task_created_at, task_id),
-	       {}),
+    tasks_sort(ctx, "tasks_sort", db::make_key(task_prio, task_created_at, task_id)),
+
+    tasks_docs(db::make_key(task_id)),
+
+    tasks_text(ctx, "tasks_text", tasks_docs, {&task_name, &task_info}),
+
+    tasks_tags(ctx, "tasks_tags", tasks_docs, task_tags),
 
     tasks_share({&task_id, &task_created_at, &task_changed_at, &task_project_id,
 	  &task_name, &task_info, &task_done, &task_done_at, &task_peer_ids})
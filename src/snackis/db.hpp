@@ -14,7 +14,10 @@
 #include "snackis/crypt/pub_key.hpp"
 #include "snackis/db/col.hpp"
 #include "snackis/db/ctx.hpp"
+#include "snackis/db/sort_index.hpp"
 #include "snackis/db/table.hpp"
+#include "snackis/db/tag_index.hpp"
+#include "snackis/db/text_index.hpp"
 
 namespace snackis {
   struct Db {
@@ -23,34 +26,49 @@ namespace snackis {
     db::Table<Invite, str> invites;
 	    
     db::Table<Peer, UId> peers;
-    db::Table<Peer, str, UId> peers_sort;
+    db::SortIndex<Peer, str, UId> peers_sort;
 
     db::Table<Script, UId> scripts;
-    db::Table<Script, str, Time, UId> scripts_sort;
+    db::SortIndex<Script, str, Time, UId> scripts_sort;
+    db::Docs<Script, UId> scripts_docs;
+    db::TextIndex<Script, UId> scripts_text;
+    db::TagIndex<Script, UId> scripts_tags;
     db::Schema<Script> scripts_share;
 
     db::Table<Feed, UId> feeds;
-    db::Table<Feed, Time, UId> feeds_sort;
+    db::SortIndex<Feed, Time, UId> feeds_sort;
+    db::Docs<Feed, UId> feeds_docs;
+    db::TagIndex<Feed, UId> feeds_tags;
     db::Schema<Feed> feeds_share;
 
     db::Table<Post, UId> posts;
-    db::Table<Post, Time, UId> posts_sort;
-    db::Table<Post, UId, Time, UId> feed_posts;
+    db::SortIndex<Post, Time, UId> posts_sort;
+    db::SortIndex<Post, UId, Time, UId> feed_posts;
+    db::Docs<Post, UId> posts_docs;
+    db::TextIndex<Post, UId> posts_text;
+    db::TagIndex<Post, UId> posts_tags;
     db::Schema<Post> posts_share;
     
     db::Table<Msg, UId> inbox, outbox;
-    db::Table<Msg, Time, UId> inbox_sort;
+    db::SortIndex<Msg, Time, UId> inbox_sort;
 
     db::Table<Project, UId> projects;
-    db::Table<Project, str, UId> projects_sort;
+    db::SortIndex<Project, str, UId> projects_sort;
+    db::Docs<Project, UId> projects_docs;
+    db::TagIndex<Project, UId> projects_tags;
     db::Schema<Project> projects_share;
 
     db::Table<Task, UId> tasks;
-    db::Table<Task, int64_t, Time, UId> tasks_sort;
+    db::SortIndex<Task, int64_t, Time, UId> tasks_sort;
+    db::Docs<Task, UId> tasks_docs;
+    db::TextIndex<Task, UId> tasks_text;
+    db::TagIndex<Task, UId> tasks_tags;
     db::Schema<Task> tasks_share;
 
     Db(Ctx &ctx);
   };
+
+  void drop_search_indexes(Db &db);
 }
 
 #endif
@@ -3,6 +3,7 @@
 
 #include <iostream>
 
+#include "snackis/core/buf.hpp"
 #include "snackis/core/str.hpp"
 #include "snackis/db/rec.hpp"
 
@@ -17,7 +18,10 @@ namespace db {
     virtual void copy(RecT &dest, const Rec<RecT> &src) const=0;
     virtual Val get(const RecT &src) const=0;
     virtual void set(RecT &dest, const Val &val) const=0;
+    virtual Val null_val() const=0;
+    virtual bool is_null(const Val &val) const=0;
     virtual Val read(std::istream &in) const=0;
+    virtual Val read(Buf &in) const=0;
     virtual void write(const Val &val, std::ostream &out) const=0;
   };
 
@@ -8,5 +8,9 @@ namespace db {
   BasicTable::BasicTable(Ctx &ctx, const str &name):
     ctx(ctx),
     name(name),
-    path(get_path(ctx, fmt("%0.tbl", name))) { }
+    path(get_path(ctx, fmt("%0.tbl", name))),
+    slurp_usecs(0)
+  { }
+
+  opt<Compactor> BasicTable::compactor() const { return nullopt; }
 }}
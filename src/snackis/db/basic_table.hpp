@@ -1,21 +1,39 @@
 #ifndef SNACKIS_DB_BASIC_TABLE_HPP
 #define SNACKIS_DB_BASIC_TABLE_HPP
 
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "snackis/core/func.hpp"
+#include "snackis/core/opt.hpp"
 #include "snackis/core/path.hpp"
 #include "snackis/core/str.hpp"
 
 namespace snackis {  
 namespace db {
   struct Ctx;
+
+  struct Span {
+    std::istream *in;
+    int64_t end;
+  };
+  
+  using Compactor = func<int64_t (const std::vector<Span> &, std::ostream &)>;
   
   struct BasicTable {
     Ctx &ctx;
     const str name;
     const Path path;
+    int64_t slurp_usecs;
+    // Recovery notes from slurp, logged once loading is done since
+    // tables are slurped from loader threads
+    std::vector<str> slurp_log;
     
     BasicTable(Ctx &ctx, const str &name);
     virtual void dump(std::ostream &out) = 0;
     virtual void slurp() = 0;
+    virtual opt<Compactor> compactor() const;
   };
 }}
 
@@ -4,6 +4,12 @@
 
 namespace snackis {
 namespace db {
+  Change::~Change() { }
+  
+  Commit::Commit(int64_t seq, Ctx *sender, const Changes &changes):
+    seq(seq), sender(sender), changes(changes)
+  { }
+  
   ChangeSet::ChangeSet(Ctx &ctx, const str &lbl, Changes &chs):
     ctx(ctx), label(lbl), committed_at(now())
   {
@@ -1,24 +1,43 @@
 #ifndef SNACKIS_DB_CHANGE_HPP
 #define SNACKIS_DB_CHANGE_HPP
 
+#include <cstdint>
 #include <memory>
+#include <vector>
+
+#include "snackis/core/opt.hpp"
 #include "snackis/core/str.hpp"
 #include "snackis/core/time.hpp"
+#include "snackis/db/basic_table.hpp"
 
 namespace snackis {
 namespace db {
   struct Ctx;
+  struct Frame;
   
   struct Change {
+    virtual ~Change();
     virtual Path table_path() const = 0;
-    virtual void write(std::ostream &out) const = 0;
+    virtual void write(Frame &out) const = 0;
     virtual void apply(Ctx &ctx) const = 0;
     virtual void rollback() const = 0;
     virtual void undo() const = 0;
+    virtual int64_t dead_recs() const = 0;
+    virtual opt<Compactor> compactor() const = 0;
   };
 
   using Changes = std::vector<std::shared_ptr<Change>>;
 
+  struct Commit {
+    const int64_t seq;
+    Ctx *const sender;
+    const Changes changes;
+
+    Commit(int64_t seq, Ctx *sender, const Changes &changes);
+  };
+
+  using Commits = std::vector<std::shared_ptr<const Commit>>;
+
   struct ChangeSet {
     Ctx &ctx;
     str label;
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "snackis/db/basic_table.hpp"
 #include "snackis/db/ctx.hpp"
 #include "snackis/db/error.hpp"
@@ -7,7 +9,7 @@
 namespace snackis {
 namespace db {
   ChangeLoop::ChangeLoop(Proc &p, size_t max_buf):
-    Loop(p, max_buf)
+    Loop(p, max_buf), next_seq(0)
   {
     start(*this);
   }
@@ -15,34 +17,60 @@ namespace db {
   ChangeLoop::~ChangeLoop() {
     stop(*this);
   }
+
+  static void reclaim(ChangeLoop &lp) {
+    int64_t min(lp.next_seq);
+    for (auto &c: lp.cursors) { min = std::min(min, c.second); }
+    
+    while (!lp.commits.empty() && lp.commits.front()->seq < min) {
+      lp.commits.pop_front();
+    }
+  }
+  
+  static Commits read_commits(ChangeLoop &lp, Ctx *ctx) {
+    auto &cur(lp.cursors[ctx]);
+    Commits out;
+
+    if (!lp.commits.empty()) {
+      const int64_t skip(std::max(cur - lp.commits.front()->seq, int64_t(0)));
+      
+      for (auto i(lp.commits.begin()+skip); i != lp.commits.end(); i++) {
+	if ((*i)->sender != ctx) { out.push_back(*i); }
+      }
+    }
+    
+    cur = lp.next_seq;
+    return out;
+  }
   
   void ChangeLoop::on_msg(const Msg &msg) {
     auto ctx(get(msg, Msg::SENDER));
 
     switch (msg.type) {
     case MSG_CONNECT:
-      queues.emplace(ctx, Changes());
+      cursors.emplace(ctx, next_seq);
       break;
     case MSG_DISCONNECT:
-      queues.erase(ctx);
+      cursors.erase(ctx);
+      reclaim(*this);
       break;
     case MSG_COMMIT: {
-      auto cs(get(msg, Msg::CHANGES));
+      auto readers(std::count_if(cursors.begin(), cursors.end(),
+				 [ctx](auto &c) { return c.first != ctx; }));
       
-      for (auto &q: queues) {
-	if (q.first != ctx) {
-	  std::copy(cs.begin(), cs.end(), std::back_inserter(q.second));
-	}
+      if (readers) {
+	commits.push_back(std::make_shared<const Commit>(next_seq, ctx,
+							 get(msg, Msg::CHANGES)));
+	next_seq++;
       }
-
+      
       break;
     }
     case MSG_REFRESH: {
-      auto &q(queues[ctx]);
       Msg msg(MSG_OK);
-      set(msg, Msg::CHANGES, q);
+      set(msg, Msg::COMMITS, read_commits(*this, ctx));
       put(ctx->inbox, msg);
-      q.clear();
+      reclaim(*this);
       break;
     }
     default:
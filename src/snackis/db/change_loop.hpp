@@ -1,6 +1,7 @@
 #ifndef SNACKIS_DB_CHANGE_LOOP_HPP
 #define SNACKIS_DB_CHANGE_LOOP_HPP
 
+#include <deque>
 #include <fstream>
 #include <map>
 
@@ -13,7 +14,9 @@ namespace db {
   struct Proc;
   
   struct ChangeLoop: Loop {
-    std::map<Ctx *, Changes> queues;
+    int64_t next_seq;
+    std::deque<std::shared_ptr<const Commit>> commits;
+    std::map<Ctx *, int64_t> cursors;
     
     ChangeLoop(Proc &p, size_t max_buf);
     ~ChangeLoop();
@@ -0,0 +1,48 @@
+#include <cstring>
+
+#include "snackis/db/checkpoint.hpp"
+
+namespace snackis {
+namespace db {
+  Path checkpoint_path(const Path &p) {
+    Path out(p);
+    return out.replace_extension(".chk");
+  }
+
+  void write_checkpoint(std::ostream &out, int64_t end) {
+    out.write(reinterpret_cast<const char *>(&CHECKPOINT_TAG),
+	      sizeof CHECKPOINT_TAG);
+    out.write(reinterpret_cast<const char *>(&end), sizeof end);
+  }
+
+  static opt<int64_t> checkpoint_end(int64_t tag, int64_t end, const Path &p) {
+    if (tag != CHECKPOINT_TAG || end < 0) { return nullopt; }
+    std::error_code err;
+    const auto size(stdfs::file_size(p, err));
+    if (err || end > int64_t(size)) { return nullopt; }
+    return end;
+  }
+  
+  opt<int64_t> read_checkpoint(std::istream &in, const Path &p) {
+    int64_t tag(0), end(-1);
+    in.read(reinterpret_cast<char *>(&tag), sizeof tag);
+    in.read(reinterpret_cast<char *>(&end), sizeof end);
+
+
+    if (in.fail()) {
+      in.clear();
+      return nullopt;
+    }
+
+    return checkpoint_end(tag, end, p);
+  }
+
+  opt<int64_t> read_checkpoint(Buf &in, const Path &p) {
+    int64_t tag(0), end(-1);
+    auto data(take(in, sizeof tag + sizeof end));
+    if (!data) { return nullopt; }
+    memcpy(&tag, data, sizeof tag);
+    memcpy(&end, data + sizeof tag, sizeof end);
+    return checkpoint_end(tag, end, p);
+  }
+}}
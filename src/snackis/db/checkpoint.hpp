@@ -0,0 +1,21 @@
+#ifndef SNACKIS_DB_CHECKPOINT_HPP
+#define SNACKIS_DB_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <iostream>
+
+#include "snackis/core/buf.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/core/path.hpp"
+
+namespace snackis {
+namespace db {
+  const int64_t CHECKPOINT_TAG(0x31504b4843534e53);
+  
+  Path checkpoint_path(const Path &p);
+  void write_checkpoint(std::ostream &out, int64_t end);
+  opt<int64_t> read_checkpoint(std::istream &in, const Path &p);
+  opt<int64_t> read_checkpoint(Buf &in, const Path &p);
+}}
+
+#endif
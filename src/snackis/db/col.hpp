@@ -21,7 +21,10 @@ namespace db {
     void copy(RecT &dest, const Rec<RecT> &src) const override;
     Val get(const RecT &src) const override;
     void set(RecT &dest, const Val &val) const override;
+    Val null_val() const override;
+    bool is_null(const Val &val) const override;
     Val read(std::istream &in) const override;
+    Val read(Buf &in) const override;
     void write(const Val &val, std::ostream &out) const override;
   };
 
@@ -57,11 +60,26 @@ namespace db {
     rec.*field = type.from_val(val);
   }
 
+  template <typename RecT, typename ValT>
+  Val Col<RecT, ValT>::null_val() const {
+    return type.to_val(type.null);
+  }
+
+  template <typename RecT, typename ValT>
+  bool Col<RecT, ValT>::is_null(const Val &val) const {
+    return type.is_null(type.from_val(val));
+  }
+
   template <typename RecT, typename ValT>
   Val Col<RecT, ValT>::read(std::istream &in) const {
     return type.read_val(in);
   }
 
+  template <typename RecT, typename ValT>
+  Val Col<RecT, ValT>::read(Buf &in) const {
+    return type.read_val(in);
+  }
+
   template <typename RecT, typename ValT>
   void Col<RecT, ValT>::write(const Val &val, std::ostream &out) const {
     type.write_val(val, out);
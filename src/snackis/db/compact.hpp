@@ -0,0 +1,132 @@
+#ifndef SNACKIS_DB_COMPACT_HPP
+#define SNACKIS_DB_COMPACT_HPP
+
+#include <cstdint>
+#include <map>
+
+#include "snackis/crypt/secret.hpp"
+#include "snackis/db/basic_table.hpp"
+#include "snackis/db/error.hpp"
+#include "snackis/db/frame.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/schema.hpp"
+
+namespace snackis {
+namespace db {
+  template <typename RecT>
+  struct Patch {
+    TableOp op;
+    Rec<RecT> rec, prev;
+  };
+
+  template <typename RecT, typename...KeyT>
+  Patch<RecT> make_patch(const Key<RecT, KeyT...> &key,
+			 const Rec<RecT> &rec,
+			 const Rec<RecT> &prev) {
+    if (key(rec) != key(prev)) { return Patch<RecT> {TABLE_UPDATE, rec, prev}; }
+    Patch<RecT> out {TABLE_PATCH, Rec<RecT>(), Rec<RecT>()};
+    
+    for (auto &f: rec) {
+      auto fnd(prev.find(f.first));
+
+      if (fnd == prev.end()) {
+	out.rec.insert(f);
+	out.prev.erased.insert(f.first);
+      } else if (fnd->second < f.second || f.second < fnd->second) {
+	out.rec.insert(f);
+	out.prev.insert(*fnd);
+      }
+    }
+
+    for (auto &f: prev) {
+      if (rec.find(f.first) == rec.end()) {
+	out.rec.erased.insert(f.first);
+	out.prev.insert(f);
+      }
+    }
+
+    copy(key, out.rec, rec);
+    copy(key, out.prev, rec);
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  Compactor make_compactor(const Schema<RecT> &scm,
+			   const Key<RecT, KeyT...> &key,
+			   const opt<crypt::Secret> &sec) {
+    return [scm, key, sec](const std::vector<Span> &spans, std::ostream &out) {
+      std::map<typename Key<RecT, KeyT...>::Type, Rec<RecT>> recs;
+      bool ok(true);
+      
+      auto apply([&key, &recs, &ok](uint8_t op, const Rec<RecT> &rec) {
+	  auto k(key(rec));
+	  
+	  switch (op) {
+	  case TABLE_INSERT:
+	    recs.emplace(k, rec);
+	    break;
+	  case TABLE_UPDATE:
+	    recs[k] = rec;
+	    break;
+	  case TABLE_ERASE:
+	    recs.erase(k);
+	    break;
+	  case TABLE_PATCH: {
+	    auto fnd(recs.find(k));
+	    if (fnd != recs.end()) { patch(fnd->second, rec); }
+	    break;
+	  }
+	  default:
+	    ERROR(Db, fmt("Invalid table operation: %0", op));
+	    ok = false;
+	  }
+	});
+      
+      for (auto &s: spans) {
+	auto &in(*s.in);
+
+	while (ok && in.tellg() < s.end) {
+	  uint8_t op;
+	  in.read(reinterpret_cast<char *>(&op), sizeof op);
+
+	  if (in.fail()) {
+	    ERROR(Db, "Failed reading segment");
+	    return int64_t(-1);
+	  }
+
+	  if (op == TABLE_FRAME) {
+	    Data edata;
+
+	    if (!sec || !read_frame(in, edata)) {
+	      ERROR(Db, "Failed reading frame");
+	      return int64_t(-1);
+	    }
+
+	    if (!open_frame(scm, *sec, edata, apply)) { return int64_t(-1); }
+	  } else {
+	    Rec<RecT> rec;
+	    read(scm, in, rec, sec);
+	    if (op == TABLE_PATCH && !sec) { read_erased(scm, in, rec); }
+
+	    if (in.fail()) {
+	      ERROR(Db, "Failed reading segment");
+	      return int64_t(-1);
+	    }
+	    
+	    apply(op, rec);
+	  }
+	}
+      }
+
+      if (!ok) { return int64_t(-1); }
+      crypt::Nonce nonce;
+      Frame f(out, sec, nonce);
+      for (auto &r: recs) { write(f, TABLE_INSERT, r.second); }
+      seal(f);
+      return int64_t(recs.size());
+    };
+  }
+}}
+
+#endif
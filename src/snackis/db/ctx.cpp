@@ -1,13 +1,18 @@
+#include <algorithm>
 #include <fstream>
+#include <thread>
+#include <vector>
+
 #include "snackis/ctx.hpp"
 #include "snackis/snackis.hpp"
 #include "snackis/crypt/error.hpp"
 #include "snackis/db/proc.hpp"
+#include "snackis/db/slurp.hpp"
 
 namespace snackis {
 namespace db {
   Ctx::Ctx(Proc &p, size_t max_buf):
-    proc(p), inbox(max_buf), trans(nullptr)
+    proc(p), inbox(max_buf), trans(nullptr), slurp_pool(nullptr)
   { 
     Msg msg(MSG_CONNECT);
     set(msg, Msg::SENDER, this);
@@ -82,9 +87,72 @@ namespace db {
 
   void slurp(Ctx &ctx) {
     TRY(try_slurp);
+    const size_t size(default_pool_size());
+    Chan<BasicTable *> todo(ctx.tables.size()+1);
+    size_t cnt(0);
+    
     for (auto t: ctx.tables) {
-      if (path_exists(t.second->path)) { t.second->slurp(); }
+      if (path_exists(t.second->path)) {
+	put(todo, t.second);
+	cnt++;
+      }
+    }
+
+    close(todo);
+    Pool pool(size, size*SLURP_DEPTH);
+    ctx.slurp_pool = &pool;
+    std::vector<std::thread> threads;
+    std::mutex errors_mutex;
+    std::deque<Error *> errors;
+    auto start(pnow());
+    
+    for (size_t i(0); i < std::min(size, cnt); i++) {
+      threads.emplace_back([&todo, &errors_mutex, &errors]() {
+	  TRY(try_table);
+	  
+	  while (true) {
+	    auto t(get(todo));
+	    if (!t) { break; }
+	    auto start(pnow());
+	    (*t)->slurp();
+	    (*t)->slurp_usecs = usecs(pnow()-start);
+	  }
+
+	  std::unique_lock<std::mutex> lock(errors_mutex);
+	  std::move(try_table.errors.begin(), try_table.errors.end(),
+		    std::back_inserter(errors));
+	  try_table.errors.clear();
+	});
+    }
+
+    for (auto &t: threads) { t.join(); }
+    ctx.slurp_pool = nullptr;
+    for (auto e: errors) { throw_error(e); }
+
+    for (auto t: ctx.tables) {
+      for (auto &m: t.second->slurp_log) { log(ctx, m); }
+      t.second->slurp_log.clear();
+    }
+
+    log(ctx, "Loaded %0 tables in %1ms", cnt, usecs(pnow()-start) / 1000);
+  }
+
+  str fmt_slurp_stats(const Ctx &ctx) {
+    std::vector<const BasicTable *> tables;
+    for (auto &t: ctx.tables) { tables.push_back(t.second); }
+    
+    std::sort(tables.begin(), tables.end(), [](auto x, auto y) {
+	return x->slurp_usecs > y->slurp_usecs;
+      });
+
+    Stream out;
+    out << "Table load time (us):";
+    
+    for (auto t: tables) {
+      out << std::endl << t->name << ": " << t->slurp_usecs;
     }
+
+    return out.str();
   }
 
   int64_t rewrite(Ctx &ctx) {
@@ -96,6 +164,22 @@ namespace db {
     return (res && res->type == MSG_OK) ? get(*res, Msg::RECLAIMED) : -1;
   }
 
+  void compact(Ctx &ctx) {
+    TRY(try_compact);
+    Msg msg(MSG_COMPACT);
+    set(msg, Msg::SENDER, &ctx);
+    put(ctx.proc.inbox, msg);
+    get(ctx.inbox);
+  }
+
+  void sync(Ctx &ctx) {
+    TRY(try_sync);
+    Msg msg(MSG_SYNC);
+    set(msg, Msg::SENDER, &ctx);
+    put(ctx.proc.inbox, msg);
+    get(ctx.inbox);
+  }
+
   int64_t refresh(Ctx &ctx) {
     TRY(try_refresh);
     Msg msg(MSG_REFRESH);
@@ -104,9 +188,14 @@ namespace db {
     auto res(get(ctx.inbox));
     
     if (res && res->type == MSG_OK) {
-      auto cs(get(*res, Msg::CHANGES));
-      for (auto &c: cs) { c->apply(ctx); }
-      return cs.size();
+      int64_t cnt(0);
+      
+      for (auto &cm: get(*res, Msg::COMMITS)) {
+	for (auto &c: cm->changes) { c->apply(ctx); }
+	cnt += cm->changes.size();
+      }
+      
+      return cnt;
     }
 
     return -1;
@@ -8,6 +8,7 @@
 #include "snackis/core/func.hpp"
 #include "snackis/core/opt.hpp"
 #include "snackis/core/path.hpp"
+#include "snackis/core/pool.hpp"
 #include "snackis/core/str.hpp"
 #include "snackis/crypt/secret.hpp"
 #include "snackis/db/change.hpp"
@@ -29,6 +30,7 @@ namespace db {
     opt<crypt::Secret> secret;
     std::map<str, BasicTable *> tables;
     Trans *trans;
+    Pool *slurp_pool;
     std::list<ChangeSet> undo_stack;
     
     Ctx(Proc &p, size_t max_buf);
@@ -42,7 +44,10 @@ namespace db {
   bool login(Ctx &ctx, const str &pass);
   void open(Ctx &ctx);
   void slurp(Ctx &ctx);
+  str fmt_slurp_stats(const Ctx &ctx);
   int64_t rewrite(Ctx &ctx);
+  void compact(Ctx &ctx);
+  void sync(Ctx &ctx);
   int64_t refresh(Ctx &ctx);
 
   template <typename...Args>
@@ -0,0 +1,122 @@
+#ifndef SNACKIS_DB_DOCS_HPP
+#define SNACKIS_DB_DOCS_HPP
+
+#include <map>
+#include <vector>
+
+#include "snackis/core/bitmap.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/rec.hpp"
+
+namespace snackis {
+namespace db {
+  // Maps keys to dense doc ids shared by all indexes of a table, each index
+  // tracks the ids it holds and ids are recycled once no index holds them.
+  template <typename RecT, typename...KeyT>
+  struct Docs {
+    using Key = db::Key<RecT, KeyT...>;
+
+    const Key key;
+    std::map<typename Key::Type, int64_t> ids;
+    std::vector<const Rec<RecT> *> recs;
+    std::vector<int64_t> refs, free_ids;
+
+    Docs(const Key &key);
+  };
+
+  template <typename RecT, typename...KeyT>
+  Docs<RecT, KeyT...>::Docs(const Key &key):
+    key(key)
+  { }
+
+  template <typename RecT, typename...KeyT>
+  int64_t new_id(Docs<RecT, KeyT...> &docs) {
+    if (docs.free_ids.empty()) {
+      docs.recs.push_back(nullptr);
+      docs.refs.push_back(0);
+      return docs.recs.size()-1;
+    }
+
+    const int64_t id(docs.free_ids.back());
+    docs.free_ids.pop_back();
+    return id;
+  }
+  
+  template <typename RecT, typename...KeyT>
+  opt<int64_t> insert(Docs<RecT, KeyT...> &docs,
+		      const Rec<RecT> &rec,
+		      Bitmap &held) {
+    const auto k(docs.key(rec));
+    auto fnd(docs.ids.find(k));
+    int64_t id(-1);
+    
+    if (fnd == docs.ids.end()) {
+      id = new_id(docs);
+      docs.ids.emplace(k, id);
+    } else {
+      id = fnd->second;
+      if (test(held, id)) { return nullopt; }
+    }
+
+    set(held, id);
+    docs.recs[id] = &rec;
+    docs.refs[id]++;
+    return id;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<int64_t> update(Docs<RecT, KeyT...> &docs,
+		      const Rec<RecT> &rec,
+		      const Rec<RecT> &prev,
+		      const Bitmap &held) {
+    const auto k(docs.key(rec));
+    auto fnd(docs.ids.find(docs.key(prev)));
+
+    // Key may already have been moved by another index of the same table
+    if (fnd == docs.ids.end()) { fnd = docs.ids.find(k); }
+    if (fnd == docs.ids.end() || !test(held, fnd->second)) { return nullopt; }
+    const int64_t id(fnd->second);
+
+    if (k != fnd->first) {
+      docs.ids.erase(fnd);
+      docs.ids.emplace(k, id);
+    }
+
+    docs.recs[id] = &rec;
+    return id;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<int64_t> erase(Docs<RecT, KeyT...> &docs,
+		     const Rec<RecT> &rec,
+		     Bitmap &held) {
+    auto fnd(docs.ids.find(docs.key(rec)));
+    if (fnd == docs.ids.end() || !clear(held, fnd->second)) { return nullopt; }
+    const int64_t id(fnd->second);
+
+    if (!--docs.refs[id]) {
+      docs.recs[id] = nullptr;
+      docs.ids.erase(fnd);
+      docs.free_ids.push_back(id);
+    }
+    
+    return id;
+  }
+
+  template <typename RecT, typename...KeyT, typename IdsT>
+  std::vector<const Rec<RecT> *> get_recs(const Docs<RecT, KeyT...> &docs,
+					  const IdsT &ids) {
+    std::vector<const Rec<RecT> *> out;
+    out.reserve(ids.size());
+
+    for (auto id: ids) {
+      auto rec(docs.recs[id]);
+      if (rec) { out.push_back(rec); }
+    }
+
+    return out;
+  }
+}}
+
+#endif
@@ -0,0 +1,50 @@
+#include "snackis/core/int64_type.hpp"
+#include "snackis/db/frame.hpp"
+
+namespace snackis {
+namespace db {
+  Frame::Frame(std::ostream &out,
+	       const opt<crypt::Secret> &sec,
+	       crypt::Nonce &nonce,
+	       size_t max):
+    out(out), sec(sec), nonce(nonce), max(max), recs(0)
+  { }
+
+  void seal(Frame &f) {
+    if (!f.recs) { return; }
+    f.recs = 0;
+    if (!f.sec) { return; }
+    const str data(f.buf.str());
+    f.buf.str("");
+    crypt::next(f.nonce);
+    const Data edata(encrypt(*f.sec, f.nonce,
+			     reinterpret_cast<const unsigned char *>(data.data()),
+			     data.size()));
+    const uint8_t op(TABLE_FRAME);
+    f.out.write(reinterpret_cast<const char *>(&op), sizeof op);
+    set_int64_bin(f.out);
+    int64_type.write(edata.size(), f.out);
+    f.out.write(reinterpret_cast<const char *>(edata.data()), edata.size());
+  }
+
+  bool read_frame(std::istream &in, Data &out) {
+    const int64_t size(int64_type.read(in));
+    if (in.fail() || size < 0) { return false; }
+    out.resize(size);
+    in.read(reinterpret_cast<char *>(out.data()), size);
+    return !in.fail();
+  }
+
+  const unsigned char *read_frame(Buf &in, size_t &len) {
+    const int64_t size(int64_type.read(in));
+    if (in.fail) { return nullptr; }
+
+    if (size < 0) {
+      in.fail = true;
+      return nullptr;
+    }
+
+    len = size;
+    return reinterpret_cast<const unsigned char *>(take(in, len));
+  }
+}}
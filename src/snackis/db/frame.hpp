@@ -0,0 +1,95 @@
+#ifndef SNACKIS_DB_FRAME_HPP
+#define SNACKIS_DB_FRAME_HPP
+
+#include <cstdint>
+#include <iostream>
+
+#include "snackis/core/buf.hpp"
+#include "snackis/core/data.hpp"
+#include "snackis/core/int64_type.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/core/stream.hpp"
+#include "snackis/crypt/secret.hpp"
+#include "snackis/db/error.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/schema.hpp"
+
+namespace snackis {
+namespace db {
+  enum TableOp {TABLE_INSERT, TABLE_UPDATE, TABLE_ERASE, TABLE_PATCH,
+		TABLE_FRAME};
+
+  const size_t FRAME_RECS(256);
+  
+  struct Frame {
+    std::ostream &out;
+    const opt<crypt::Secret> sec;
+    crypt::Nonce &nonce;
+    const size_t max;
+    Stream buf;
+    size_t recs;
+    
+    Frame(std::ostream &out,
+	  const opt<crypt::Secret> &sec,
+	  crypt::Nonce &nonce,
+	  size_t max=FRAME_RECS);
+  };
+
+  void seal(Frame &f);
+  bool read_frame(std::istream &in, Data &out);
+  const unsigned char *read_frame(Buf &in, size_t &len);
+  
+  template <typename RecT>
+  void write(std::ostream &out, TableOp _op, const Rec<RecT> &rec) {
+    uint8_t op(_op);
+    set_int64_bin(out);
+    out.write(reinterpret_cast<const char *>(&op), sizeof op);
+    write(rec, out, nullopt);
+    if (_op == TABLE_PATCH) { write_erased(rec, out); }
+  }
+
+  template <typename RecT>
+  void write(Frame &f, TableOp op, const Rec<RecT> &rec) {
+    write(f.sec ? f.buf : f.out, op, rec);
+    f.recs++;
+    if (f.max && f.recs == f.max) { seal(f); }
+  }
+
+  template <typename RecT, typename FnT>
+  bool open_frame(const Schema<RecT> &scm,
+		  const crypt::Secret &sec,
+		  const unsigned char *edata, size_t len,
+		  FnT fn) {
+    TRY(try_open);
+    const Data ddata(decrypt(sec, edata, len));
+    if (!try_open.errors.empty()) { return false; }
+    auto beg(reinterpret_cast<const char *>(ddata.data()));
+    Buf buf(beg, beg+ddata.size());
+    
+    while (!eof(buf)) {
+      const uint8_t op(*take(buf, 1));
+      Rec<RecT> rec;
+      read(scm, buf, rec);
+      if (op == TABLE_PATCH) { read_erased(scm, buf, rec); }
+      
+      if (buf.fail) {
+	ERROR(Db, "Failed reading frame");
+	return false;
+      }
+      
+      fn(op, rec);
+    }
+
+    return true;
+  }
+
+  template <typename RecT, typename FnT>
+  bool open_frame(const Schema<RecT> &scm,
+		  const crypt::Secret &sec,
+		  const Data &edata,
+		  FnT fn) {
+    return open_frame(scm, sec, edata.data(), edata.size(), fn);
+  }
+}}
+
+#endif
@@ -3,11 +3,25 @@
 namespace snackis {
 namespace db {
   static void run(Loop *lp) {
+    std::vector<Msg> batch;
+    
     while (true) {
       TRY(try_msg);
-      auto msg(get(lp->inbox));
-      if (!msg) { break; }
-      lp->on_msg(*msg);
+      batch.clear();
+      auto idle(lp->idle_usecs());
+      
+      if (idle) {
+	if (!get_all(lp->inbox, batch, lp->inbox.max,
+		     std::chrono::microseconds(*idle))) {
+	  if (is_closed(lp->inbox)) { break; }
+	  lp->on_idle();
+	  continue;
+	}
+      } else if (!get_all(lp->inbox, batch, lp->inbox.max)) {
+	break;
+      }
+      
+      lp->on_batch(batch);
     }
   }
 		   
@@ -16,6 +30,14 @@ namespace db {
     inbox(max_buf)
   { }
   
+  void Loop::on_batch(const std::vector<Msg> &msgs) {
+    for (auto &m: msgs) { on_msg(m); }
+  }
+
+  opt<int64_t> Loop::idle_usecs() { return nullopt; }
+
+  void Loop::on_idle() { }
+  
   void start(Loop &lp) {
     lp.thread = std::thread(run, &lp);
   }
@@ -2,7 +2,10 @@
 #define SNACKIS_DB_LOOP_HPP
 
 #include <thread>
+#include <vector>
+
 #include "snackis/core/chan.hpp"
+#include "snackis/core/opt.hpp"
 #include "snackis/db/msg.hpp"
 
 namespace snackis {
@@ -16,6 +19,12 @@ namespace db {
     
     Loop(Proc &proc, size_t max_buf);
     virtual void on_msg(const Msg &msg)=0;
+    virtual void on_batch(const std::vector<Msg> &msgs);
+
+    // Returns how long to wait for messages before calling on_idle,
+    // nullopt blocks until the next message arrives.
+    virtual opt<int64_t> idle_usecs();
+    virtual void on_idle();
   };
 
   void start(Loop &lp);
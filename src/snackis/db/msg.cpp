@@ -3,7 +3,12 @@
 namespace snackis {
 namespace db {
   const MsgFld<Changes> Msg::CHANGES("changes");
+  const MsgFld<Commits> Msg::COMMITS("commits");
+  const MsgFld<int64_t> Msg::GEN("gen");
+  const MsgFld<str> Msg::PATH("path");
+  const MsgFld<int64_t> Msg::QUEUED("queued");
   const MsgFld<int64_t> Msg::RECLAIMED("reclaimed");
+  const MsgFld<int64_t> Msg::RECS("recs");
   const MsgFld<Ctx *> Msg::SENDER("sender");
 
   BasicMsgFld::BasicMsgFld(const str id):
@@ -29,13 +29,19 @@ namespace db {
 
   enum MsgType { MSG_CONNECT, MSG_DISCONNECT,
 		 MSG_COMMIT, MSG_REFRESH, MSG_REWRITE,
+		 MSG_COMPACT, MSG_COMPACTED, MSG_CHECKPOINTED, MSG_SYNC,
 		 MSG_OK, MSG_ERROR };
 
   struct Msg {
-    using Val = std::variant<int64_t, Ctx *, Changes>;
+    using Val = std::variant<int64_t, str, Ctx *, Changes, Commits>;
 
     static const MsgFld<Changes> CHANGES;
+    static const MsgFld<Commits> COMMITS;
+    static const MsgFld<int64_t> GEN;
+    static const MsgFld<str> PATH;
+    static const MsgFld<int64_t> QUEUED;
     static const MsgFld<int64_t> RECLAIMED;
+    static const MsgFld<int64_t> RECS;
     static const MsgFld<Ctx *> SENDER;
     
     const MsgType type;
@@ -5,6 +5,13 @@
 
 namespace snackis {
 namespace db {
+  static void write_db_rev(const Path &p) {
+    std::ofstream out;
+    out.open(p.string(), std::ios::out | std::ios::trunc | std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&DB_REV), sizeof(DB_REV));
+    out.close();
+  }
+  
   static bool init_db_rev(Proc &proc) {
     const Path p(proc.path / "rev");
     
@@ -15,20 +22,21 @@ namespace db {
       in.read(reinterpret_cast<char *>(&rev), sizeof rev);
       in.close();
 
-      if (rev < DB_REV) {
+      if (rev < MIN_DB_REV) {
 	ERROR(Db, fmt("This version of Snackis requires database revision #%0 to run",
-		      DB_REV));
+		      MIN_DB_REV));
 	return false;
       }
 
+      if (rev < DB_REV) {
+	write_db_rev(p);
+	log(proc, "Upgraded database from revision %0 to %1", rev, DB_REV);
+      }
+      
       return true;
     }
     
-    std::ofstream out;
-    out.open(p.string(), std::ios::out | std::ios::trunc | std::ios::binary);
-    out.write(reinterpret_cast<const char *>(&DB_REV), sizeof(DB_REV));
-    out.close();
-
+    write_db_rev(p);
     log(proc, "Initialized database, revision %0", DB_REV);
     return true;
   }
@@ -49,29 +57,42 @@ namespace db {
   }
   
   void Proc::on_msg(const Msg &msg) {
-    auto ctx(get(msg, Msg::SENDER));
+    on_batch({msg});
+  }
+  
+  void Proc::on_batch(const std::vector<Msg> &msgs) {
+    std::vector<Msg> writes, changes;
+    
+    for (auto &msg: msgs) {
+      auto ctx(get(msg, Msg::SENDER));
     
-    switch (msg.type) {
-    case MSG_CONNECT:
-      put(ctx->inbox, Msg(MSG_OK));      
-      put(change_loop.inbox, msg);
-      break;
-    case MSG_DISCONNECT:
-      put(ctx->inbox, Msg(MSG_OK));      
-      put(change_loop.inbox, msg);
-      break;
-    case MSG_COMMIT:
-      put(write_loop.inbox, msg);
-      put(change_loop.inbox, msg);
-      break;
-    case MSG_REFRESH:
-      put(change_loop.inbox, msg);
-      break;      
-    case MSG_REWRITE:
-      put(write_loop.inbox, msg);
-      break;
-    default:
-      log(*this, "Invalid message type: %0", msg.type);
+      switch (msg.type) {
+      case MSG_CONNECT:
+	put(ctx->inbox, Msg(MSG_OK));      
+	changes.push_back(msg);
+	break;
+      case MSG_DISCONNECT:
+	put(ctx->inbox, Msg(MSG_OK));      
+	changes.push_back(msg);
+	break;
+      case MSG_COMMIT:
+	writes.push_back(msg);
+	changes.push_back(msg);
+	break;
+      case MSG_REFRESH:
+	changes.push_back(msg);
+	break;      
+      case MSG_REWRITE:
+      case MSG_COMPACT:
+      case MSG_SYNC:
+	writes.push_back(msg);
+	break;
+      default:
+	log(*this, "Invalid message type: %0", msg.type);
+      }
     }
+
+    put_all(write_loop.inbox, writes);
+    put_all(change_loop.inbox, changes);
   }
 }}
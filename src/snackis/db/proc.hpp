@@ -18,6 +18,7 @@ namespace db {
     Proc(const Path &p, size_t max_buf);
     ~Proc();
     void on_msg(const Msg &msg) override;
+    void on_batch(const std::vector<Msg> &msgs) override;
   };
 
   template <typename...Args>
@@ -0,0 +1,257 @@
+#ifndef SNACKIS_DB_QUERY_HPP
+#define SNACKIS_DB_QUERY_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "snackis/core/func.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/core/str.hpp"
+#include "snackis/core/val.hpp"
+#include "snackis/db/col.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/sort_index.hpp"
+
+namespace snackis {
+namespace db {
+  template <typename RecT>
+  struct Pred {
+    using Fn = func<bool (const Rec<RecT> &)>;
+    const BasicCol<RecT> *col;
+    opt<Val> min, max;
+    Fn fn;
+
+    Pred(Fn fn);
+    Pred(const BasicCol<RecT> &col,
+	 const opt<Val> &min, const opt<Val> &max,
+	 Fn fn);
+  };
+
+  template <typename RecT>
+  struct Query {
+    using Rows = std::vector<const Rec<RecT> *>;
+    std::vector<Pred<RecT>> preds;
+    opt<Rows> hits;
+    bool rev;
+
+    Query(bool rev=false);
+  };
+
+  template <typename RecT, typename...KeyT>
+  struct Plan {
+    using RecIter = typename SortIndex<RecT, KeyT...>::RecIter;
+    RecIter beg, end;
+    bool ranged;
+  };
+
+  template <typename RecT>
+  Pred<RecT>::Pred(Fn fn):
+    col(nullptr), fn(fn)
+  { }
+
+  template <typename RecT>
+  Pred<RecT>::Pred(const BasicCol<RecT> &col,
+		   const opt<Val> &min, const opt<Val> &max,
+		   Fn fn):
+    col(&col), min(min), max(max), fn(fn)
+  { }
+
+  template <typename RecT>
+  Query<RecT>::Query(bool rev):
+    rev(rev)
+  { }
+
+  template <typename RecT>
+  void add(Query<RecT> &q, const Pred<RecT> &p) {
+    q.preds.push_back(p);
+  }
+
+  template <typename RecT>
+  void narrow(Query<RecT> &q, typename Query<RecT>::Rows rows) {
+    std::sort(rows.begin(), rows.end());
+
+    if (q.hits) {
+      typename Query<RecT>::Rows prev;
+      prev.swap(*q.hits);
+      q.hits->clear();
+      std::set_intersection(prev.begin(), prev.end(), rows.begin(), rows.end(),
+			    std::back_inserter(*q.hits));
+    } else {
+      q.hits.emplace(std::move(rows));
+    }
+  }
+
+  template <typename RecT, typename ValT>
+  ValT get_val(const Rec<RecT> &rec, const Col<RecT, ValT> &col) {
+    auto fnd(rec.find(&col));
+    return (fnd == rec.end()) ? col.type.null : col.type.from_val(fnd->second);
+  }
+
+  template <typename RecT, typename ValT>
+  Pred<RecT> eq(const Col<RecT, ValT> &col, const ValT &val) {
+    const Val v(col.type.to_val(val));
+
+    return Pred<RecT>(col, v, v, [&col, val](auto &rec) {
+	return get_val(rec, col) == val;
+      });
+  }
+
+  template <typename RecT, typename ValT>
+  Pred<RecT> range(const Col<RecT, ValT> &col,
+		   const opt<ValT> &min, const opt<ValT> &max) {
+    return Pred<RecT>(col,
+		      min ? opt<Val>(col.type.to_val(*min)) : nullopt,
+		      max ? opt<Val>(col.type.to_val(*max)) : nullopt,
+		      [&col, min, max](auto &rec) {
+			auto v(get_val(rec, col));
+			return (!min || !(v < *min)) && (!max || !(*max < v));
+		      });
+  }
+
+  template <typename RecT, typename ValT>
+  Pred<RecT> has(const Col<RecT, std::set<ValT>> &col, const ValT &val) {
+    return Pred<RecT>([&col, val](auto &rec) {
+	auto vs(get_val(rec, col));
+	return vs.find(val) != vs.end();
+      });
+  }
+
+  template <typename RecT, typename ValT>
+  Pred<RecT> has_all(const Col<RecT, std::set<ValT>> &col,
+		     const std::set<ValT> &vals) {
+    return Pred<RecT>([&col, vals](auto &rec) {
+	auto vs(get_val(rec, col));
+	return std::includes(vs.begin(), vs.end(), vals.begin(), vals.end());
+      });
+  }
+
+  template <typename RecT>
+  Pred<RecT> contains_ci(const Col<RecT, str> &col, const str &sel) {
+    return Pred<RecT>([&col, sel](auto &rec) {
+	return find_ci(get_val(rec, col), sel) != str::npos;
+      });
+  }
+
+  template <typename RecT>
+  Pred<RecT> any(std::initializer_list<Pred<RecT>> preds) {
+    std::vector<Pred<RecT>> ps(preds);
+
+    return Pred<RecT>([ps](auto &rec) {
+	for (auto &p: ps) {
+	  if (p.fn(rec)) { return true; }
+	}
+
+	return false;
+      });
+  }
+
+  template <typename RecT>
+  Pred<RecT> all(std::initializer_list<Pred<RecT>> preds) {
+    std::vector<Pred<RecT>> ps(preds);
+
+    return Pred<RecT>([ps](auto &rec) {
+	for (auto &p: ps) {
+	  if (!p.fn(rec)) { return false; }
+	}
+
+	return true;
+      });
+  }
+
+  template <typename RecT>
+  bool match(const Query<RecT> &q, const Rec<RecT> &rec) {
+    for (auto &p: q.preds) {
+      if (!p.fn(rec)) { return false; }
+    }
+
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  Plan<RecT, KeyT...> plan(const SortIndex<RecT, KeyT...> &idx,
+			   const Query<RecT> &q) {
+    using FirstT = std::tuple_element_t<0, std::tuple<KeyT...>>;
+    const Col<RecT, FirstT> &col(*std::get<0>(idx.key));
+    opt<FirstT> min, max;
+
+    for (auto &p: q.preds) {
+      if (p.col != &col) { continue; }
+
+      if (p.min) {
+	auto v(col.type.from_val(*p.min));
+	if (!min || *min < v) { min = v; }
+      }
+
+      if (p.max) {
+	auto v(col.type.from_val(*p.max));
+	if (!max || v < *max) { max = v; }
+      }
+    }
+
+    Plan<RecT, KeyT...> out {
+      min ? lower_bound(idx, std::make_tuple(*min)) : idx.recs.begin(),
+      max ? upper_bound(idx, std::make_tuple(*max)) : idx.recs.end(),
+      min || max
+    };
+
+    if (min && max && *max < *min) { out.end = out.beg; }
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT, typename FnT>
+  size_t scan_hits(const SortIndex<RecT, KeyT...> &idx,
+		   const Query<RecT> &q,
+		   FnT fn) {
+    using Hit = std::pair<typename SortIndex<RecT, KeyT...>::Key::Type,
+			  const Rec<RecT> *>;
+    std::vector<Hit> hits;
+
+    for (auto rec: *q.hits) {
+      if (match(q, *rec)) { hits.emplace_back(idx.key(*rec), rec); }
+    }
+
+    std::sort(hits.begin(), hits.end(), [&q](auto &x, auto &y) {
+	return q.rev ? y.first < x.first : x.first < y.first;
+      });
+
+    for (auto &h: hits) { fn(*h.second); }
+    return hits.size();
+  }
+
+  template <typename RecT, typename...KeyT, typename FnT>
+  size_t scan(const SortIndex<RecT, KeyT...> &idx,
+	      const Query<RecT> &q,
+	      FnT fn) {
+    if (q.hits) { return scan_hits(idx, q, fn); }
+    auto p(plan(idx, q));
+    size_t cnt(0);
+
+    auto visit([&q, &fn, &cnt](const Rec<RecT> &rec) {
+	if (match(q, rec)) {
+	  fn(rec);
+	  cnt++;
+	}
+      });
+
+    if (q.rev) {
+      for (auto i(p.end); i != p.beg;) { visit(*(--i)->second); }
+    } else {
+      for (auto i(p.beg); i != p.end; i++) { visit(*i->second); }
+    }
+
+    return cnt;
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::vector<const Rec<RecT> *> select(const SortIndex<RecT, KeyT...> &idx,
+					const Query<RecT> &q) {
+    std::vector<const Rec<RecT> *> out;
+    scan(idx, q, [&out](auto &rec) { out.push_back(&rec); });
+    return out;
+  }
+}}
+
+#endif
@@ -2,6 +2,8 @@
 #define SNACKIS_DB_REC_HPP
 
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 
 #include "snackis/core/int64_type.hpp"
@@ -22,7 +24,11 @@ namespace db {
   struct Schema;
 
   template <typename RecT>
-  struct Rec: std::map<const BasicCol<RecT> *, Val> {
+  struct Rec: std::map<const BasicCol<RecT> *, Val>,
+	      std::enable_shared_from_this<Rec<RecT>> {
+    // Columns removed when applied as a patch
+    std::set<const BasicCol<RecT> *> erased;
+    
     Rec();
     Rec(const Schema<RecT> &scm, const RecT &src);
     Rec(const Schema<RecT> &scm, const Rec<RecT> &src);
@@ -58,6 +64,18 @@ namespace db {
     for (auto &f: src) { f.first->set(dest, f.second); }
   }
 
+  template <typename RecT>
+  void patch(Rec<RecT> &rec, const Rec<RecT> &src) {
+    for (auto c: src.erased) { rec.erase(c); }
+    for (auto &f: src) { rec[f.first] = f.second; }
+  }
+
+  template <typename RecT>
+  void write_erased(const Rec<RecT> &rec, std::ostream &out) {
+    int64_type.write(rec.erased.size(), out);
+    for (auto c: rec.erased) { str_type.write(c->name, out); }
+  }
+  
   template <typename RecT>
   void write(const Rec<RecT> &rec,
 	     std::ostream &out,
@@ -13,6 +13,7 @@ namespace db {
     Rec<RecT> from_val(const Val &in) const override;
     Val to_val(const Rec<RecT> &in) const override;
     Rec<RecT> read(std::istream &in) const override;
+    Rec<RecT> read(Buf &in) const override;
     void write(const Rec<RecT> &val, std::ostream &out) const override;
   };
 
@@ -44,6 +45,13 @@ namespace db {
     db::read(schema, in, rec, nullopt);
     return rec;
   }
+
+  template <typename RecT>
+  Rec<RecT> RecType<RecT>::read(Buf &in) const {
+    Rec<RecT> rec;
+    db::read(schema, in, rec);
+    return rec;
+  }
   
   template <typename RecT>
   void RecType<RecT>::write(const Rec<RecT> &val, std::ostream &out) const {
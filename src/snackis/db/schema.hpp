@@ -1,6 +1,7 @@
 #ifndef SNACKIS_DB_SCHEMA_HPP
 #define SNACKIS_DB_SCHEMA_HPP
 
+#include <algorithm>
 #include <initializer_list>
 #include <vector>
 
@@ -17,7 +18,9 @@ namespace db {
   struct Schema {
     using Cols = std::initializer_list<const BasicCol<RecT> *>;
     std::vector<const BasicCol<RecT> *> cols;
-    std::map<str, const BasicCol<RecT> *> col_lookup;
+    std::map<str, const BasicCol<RecT> *, std::less<>> col_lookup;
+    // Sorted by column like Rec, so copies can walk both in step
+    std::vector<std::pair<const BasicCol<RecT> *, size_t>> col_slots;
     Schema(Cols cols);
   };
 
@@ -26,10 +29,28 @@ namespace db {
     for (auto c: cols) { add(*this, *c); }
   }
 
+  template <typename RecT>
+  auto find_col_slot(const Schema<RecT> &scm, const BasicCol<RecT> &col) {
+    return std::lower_bound(scm.col_slots.begin(), scm.col_slots.end(), &col,
+			    [](auto &x, auto y) { return x.first < y; });
+  }
+  
   template <typename RecT>
   void add(Schema<RecT> &scm, const BasicCol<RecT> &col) {
     scm.cols.push_back(&col);
     scm.col_lookup[col.name] = &col;
+    auto fnd(find_col_slot(scm, col));
+    
+    if (fnd == scm.col_slots.end() || fnd->first != &col) {
+      scm.col_slots.emplace(fnd, &col, scm.col_slots.size());
+    }
+  }
+
+  template <typename RecT>
+  opt<size_t> find_slot(const Schema<RecT> &scm, const BasicCol<RecT> &col) {
+    auto fnd(find_col_slot(scm, col));
+    if (fnd == scm.col_slots.end() || fnd->first != &col) { return nullopt; }
+    return fnd->second;
   }
 
   template <typename RecT>
@@ -109,7 +130,41 @@ namespace db {
 	}
       }
     }
-  }  
+  }
+
+  template <typename RecT>
+  void read_erased(const Schema<RecT> &scm, std::istream &in, Rec<RecT> &rec) {
+    int64_t cnt(int64_type.read(in));
+    
+    for (int64_t i=0; i<cnt && !in.fail(); i++) {
+      auto found(scm.col_lookup.find(str_type.read(in)));
+      if (found != scm.col_lookup.end()) { rec.erased.insert(found->second); }
+    }
+  }
+
+  template <typename RecT>
+  void read_erased(const Schema<RecT> &scm, Buf &in, Rec<RecT> &rec) {
+    int64_t cnt(int64_type.read(in));
+    
+    for (int64_t i=0; i<cnt && !in.fail; i++) {
+      auto found(scm.col_lookup.find(str_type.read_view(in)));
+      if (found != scm.col_lookup.end()) { rec.erased.insert(found->second); }
+    }
+  }
+
+  template <typename RecT>
+  void read(const Schema<RecT> &scm, Buf &in, Rec<RecT> &rec) {
+    int64_t cnt(int64_type.read(in));
+    
+    for (int64_t i=0; i<cnt && !in.fail; i++) {
+      auto found(scm.col_lookup.find(str_type.read_view(in)));
+	
+      if (found != scm.col_lookup.end()) {
+	auto c = found->second;
+	rec[c] = c->read(in);
+      }
+    }
+  }
 }}
 
 #endif
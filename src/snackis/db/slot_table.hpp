@@ -0,0 +1,560 @@
+#ifndef SNACKIS_DB_SLOT_TABLE_HPP
+#define SNACKIS_DB_SLOT_TABLE_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "snackis/core/fmt.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/db/change.hpp"
+#include "snackis/db/ctx.hpp"
+#include "snackis/db/error.hpp"
+#include "snackis/db/frame.hpp"
+#include "snackis/db/index.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/slots.hpp"
+#include "snackis/db/slurp.hpp"
+#include "snackis/db/table.hpp"
+#include "snackis/db/trans.hpp"
+
+namespace snackis {
+namespace db {
+  template <typename RecT, typename...KeyT>
+  struct SlotTable: Index<RecT> {
+    using Key = db::Key<RecT, KeyT...>;
+    using Rows = std::map<typename Key::Type, size_t>;
+    using RowIter = typename Rows::iterator;
+    using IndexRec = std::shared_ptr<Rec<RecT>>;
+    using OnInsert = func<void (Rec<RecT> &)>;
+    using OnUpdate = func<void (const Rec<RecT> &, Rec<RecT> &)>;
+
+    const Key key;
+    std::set<Index<RecT> *> indexes;
+    Slots<RecT> slots;
+    Rows rows;
+    // Indexes keep pointers to the recs they are given, rows that are
+    // indexed are materialized here for as long as they live.
+    std::vector<IndexRec> index_recs;
+    std::vector<OnInsert> on_insert;
+    std::vector<OnUpdate> on_update;
+
+    SlotTable(Ctx &ctx,
+	      const str &name,
+	      const Key &key,
+	      const Schema<RecT> &cols);
+    virtual ~SlotTable();
+
+    bool insert(const Rec<RecT> &rec) override;
+    bool update(const Rec<RecT> &rec, const Rec<RecT> &key) override;
+    bool erase(const Rec<RecT> &rec) override;
+
+    void dump(std::ostream &out) override;
+    void slurp() override;
+    opt<Compactor> compactor() const override;
+  };
+
+  template <typename RecT, typename...KeyT>
+  struct SlotChange: Change {
+    TableOp op;
+    SlotTable<RecT, KeyT...> &table;
+    const Rec<RecT> rec, prev_rec;
+
+    SlotChange(TableOp op,
+	       SlotTable<RecT, KeyT...> &table,
+	       const Rec<RecT> &rec,
+	       const Rec<RecT> &prev_rec=Rec<RecT>());
+    Path table_path() const override;
+    void write(Frame &out) const override;
+    void apply(Ctx &ctx) const override;
+    void rollback() const override;
+    void undo() const override;
+    int64_t dead_recs() const override;
+    opt<Compactor> compactor() const override;
+  };
+
+  template <typename RecT, typename...KeyT>
+  Rec<RecT> get_rec(const SlotTable<RecT, KeyT...> &tbl, size_t row) {
+    Rec<RecT> out;
+    copy(tbl, out, tbl.slots, row);
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<size_t> find_row(const SlotTable<RecT, KeyT...> &tbl,
+		       const typename Key<RecT, KeyT...>::Type &key) {
+    auto fnd(tbl.rows.find(key));
+    if (fnd == tbl.rows.end()) { return nullopt; }
+    return fnd->second;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<RecT> load(const SlotTable<RecT, KeyT...> &tbl, RecT &rec) {
+    auto row(find_row(tbl, tbl.key(rec)));
+    if (!row) { return nullopt; }
+    copy(tbl, rec, tbl.slots, *row);
+    return rec;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> load(const SlotTable<RecT, KeyT...> &tbl, Rec<RecT> &rec) {
+    auto row(find_row(tbl, tbl.key(rec)));
+    if (!row) { return nullopt; }
+    copy(tbl, rec, tbl.slots, *row);
+    return rec;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> find(const SlotTable<RecT, KeyT...> &tbl,
+		      const typename Key<RecT, KeyT...>::Type &key) {
+    auto row(find_row(tbl, key));
+    if (!row) { return nullopt; }
+    return get_rec(tbl, *row);
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> find(const SlotTable<RecT, KeyT...> &tbl, const KeyT &...vals) {
+    return find(tbl, tbl.key(vals...));
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> find(const SlotTable<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
+    return find(tbl, tbl.key(rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  Rec<RecT> get(const SlotTable<RecT, KeyT...> &tbl,
+		const typename Key<RecT, KeyT...>::Type &key) {
+    auto row(find_row(tbl, key));
+    CHECK(row, _);
+    return get_rec(tbl, *row);
+  }
+
+  template <typename RecT, typename...KeyT>
+  Rec<RecT> get(const SlotTable<RecT, KeyT...> &tbl, const KeyT &...vals) {
+    return get(tbl, tbl.key(vals...));
+  }
+
+  template <typename RecT, typename...KeyT>
+  Rec<RecT> get(const SlotTable<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
+    return get(tbl, tbl.key(rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  const Rec<RecT> *find_index_rec(const SlotTable<RecT, KeyT...> &tbl,
+				  size_t row) {
+    return (row < tbl.index_recs.size()) ? tbl.index_recs[row].get() : nullptr;
+  }
+  
+  template <typename RecT, typename...KeyT>
+  const Rec<RecT> &add_index_rec(SlotTable<RecT, KeyT...> &tbl, size_t row) {
+    if (tbl.index_recs.size() <= row) { tbl.index_recs.resize(row+1); }
+    auto &out(tbl.index_recs[row]);
+    out = std::make_shared<Rec<RecT>>(get_rec(tbl, row));
+    return *out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void set_row(SlotTable<RecT, KeyT...> &tbl, size_t row, const Rec<RecT> &rec) {
+    clear(tbl.slots, row);
+    copy(tbl, tbl.slots, row, rec);
+    if (find_index_rec(tbl, row)) { *tbl.index_recs[row] = get_rec(tbl, row); }
+  }
+
+  template <typename RecT, typename...KeyT>
+  size_t insert_row(SlotTable<RecT, KeyT...> &tbl,
+		    const typename Key<RecT, KeyT...>::Type &key,
+		    const Rec<RecT> &rec) {
+    auto row(add_row(tbl.slots));
+    copy(tbl, tbl.slots, row, rec);
+    tbl.rows.emplace(key, row);
+
+    if (!tbl.indexes.empty()) {
+      auto &irec(add_index_rec(tbl, row));
+      for (auto idx: tbl.indexes) { insert(*idx, irec); }
+    }
+    
+    return row;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void erase_row(SlotTable<RecT, KeyT...> &tbl,
+		 typename SlotTable<RecT, KeyT...>::RowIter it) {
+    auto irec(find_index_rec(tbl, it->second));
+    
+    if (irec) {
+      for (auto idx: tbl.indexes) { erase(*idx, *irec); }
+      tbl.index_recs[it->second].reset();
+    }
+
+    drop_row(tbl.slots, it->second);
+    tbl.rows.erase(it);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool insert(SlotTable<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
+    TRACE(fmt("Inserting into slot table: %0", tbl.name));
+    auto k(tbl.key(rec));
+    if (tbl.rows.find(k) != tbl.rows.end()) { return false; }
+    auto row(insert_row(tbl, k, rec));
+    auto irec(get_rec(tbl, row));
+
+    if (!tbl.on_insert.empty()) {
+      for (auto e: tbl.on_insert) { e(irec); }
+      set_row(tbl, row, irec);
+    }
+    
+    log_change(get_trans(tbl.ctx),
+	       new SlotChange<RecT, KeyT...>(TABLE_INSERT, tbl, irec));
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool insert(SlotTable<RecT, KeyT...> &tbl, const RecT &rec) {
+    return insert(tbl, Rec<RecT>(tbl, rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> patch_row(const SlotTable<RecT, KeyT...> &tbl,
+			   const Rec<RecT> &patch) {
+    auto out(find(tbl, tbl.key(patch)));
+    if (out) { db::patch(*out, patch); }
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> update_row(SlotTable<RecT, KeyT...> &tbl,
+			    const Rec<RecT> &rec,
+			    const typename Key<RecT, KeyT...>::Type &key) {
+    auto it(tbl.rows.find(key));
+
+    if (it == tbl.rows.end() || compare(tbl, tbl.slots, it->second, rec) == 0) {
+      return nullopt;
+    }
+
+    auto rec_key(tbl.key(rec));
+    
+    if (rec_key != key) {
+      // Updated rec replaces any row already stored under its key
+      auto fnd(tbl.rows.find(rec_key));
+      if (fnd != tbl.rows.end()) { erase_row(tbl, fnd); }
+    }
+    
+    auto row(it->second);
+    auto prev(get_rec(tbl, row));
+    set_row(tbl, row, rec);
+    
+    if (rec_key != key) {
+      tbl.rows.erase(it);
+      tbl.rows.emplace(rec_key, row);
+    }
+
+    if (!tbl.indexes.empty()) {
+      auto irec(find_index_rec(tbl, row));
+      if (!irec) { irec = &add_index_rec(tbl, row); }
+      for (auto idx: tbl.indexes) { update(*idx, *irec, prev); }
+    }
+    
+    return prev;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool update(SlotTable<RecT, KeyT...> &tbl,
+	      const Rec<RecT> &rec,
+	      const typename Key<RecT, KeyT...>::Type &key) {
+    TRACE(fmt("Updating slot table: %0", tbl.name));
+    auto prev(update_row(tbl, rec, key));
+    if (!prev) { return false; }
+    auto row(*find_row(tbl, tbl.key(rec)));
+    auto urec(get_rec(tbl, row));
+
+    if (!tbl.on_update.empty()) {
+      for (auto e: tbl.on_update) { e(*prev, urec); }
+      set_row(tbl, row, urec);
+    }
+    
+    auto p(make_patch(tbl.key, urec, *prev));
+    log_change(get_trans(tbl.ctx),
+	       new SlotChange<RecT, KeyT...>(p.op, tbl, p.rec, p.prev));
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool update(SlotTable<RecT, KeyT...> &tbl,
+	      const Rec<RecT> &rec,
+	      const Rec<RecT> &key) {
+    return update(tbl, rec, tbl.key(key));
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool update(SlotTable<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
+    return update(tbl, rec, rec);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool update(SlotTable<RecT, KeyT...> &tbl, const RecT &rec) {
+    return update(tbl, Rec<RecT>(tbl, rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool upsert(SlotTable<RecT, KeyT...> &tbl, const RecT &rec) {
+    const Rec<RecT> tbl_rec(tbl, rec);
+    if (update(tbl, tbl_rec)) { return false; }
+    insert(tbl, tbl_rec);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool erase(SlotTable<RecT, KeyT...> &tbl,
+	     const typename Key<RecT, KeyT...>::Type &key) {
+    TRACE(fmt("Erasing from slot table: %0", tbl.name));
+    auto it(tbl.rows.find(key));
+    if (it == tbl.rows.end()) { return false; }
+    log_change(get_trans(tbl.ctx),
+	       new SlotChange<RecT, KeyT...>(TABLE_ERASE, tbl,
+					     get_rec(tbl, it->second)));
+    erase_row(tbl, it);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool erase(SlotTable<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
+    return erase<RecT, KeyT...>(tbl, tbl.key(rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool erase(SlotTable<RecT, KeyT...> &tbl, const RecT &rec) {
+    return erase<RecT, KeyT...>(tbl, tbl.key(rec));
+  }
+
+  template <typename RecT, typename...KeyT>
+  void dump(SlotTable<RecT, KeyT...> &tbl, std::ostream &out) {
+    crypt::Nonce nonce;
+    Frame f(out, tbl.ctx.secret, nonce);
+    
+    for (auto &r: tbl.rows) {
+      write(f, TABLE_INSERT, get_rec(tbl, r.second));
+    }
+
+    seal(f);
+  }
+
+  template <typename RecT, typename...KeyT>
+  void replay(SlotTable<RecT, KeyT...> &tbl, uint8_t op, const Rec<RecT> &rec) {
+    auto k(tbl.key(rec));
+    auto fnd(tbl.rows.find(k));
+
+    switch (op) {
+    case TABLE_INSERT:
+      if (fnd == tbl.rows.end()) { insert_row(tbl, k, rec); }
+      break;
+    case TABLE_UPDATE:
+      if (fnd != tbl.rows.end()) { erase_row(tbl, fnd); }
+      insert_row(tbl, k, rec);
+      break;
+    case TABLE_ERASE:
+      if (fnd != tbl.rows.end()) { erase_row(tbl, fnd); }
+      break;
+    case TABLE_PATCH:
+      if (fnd != tbl.rows.end()) {
+	auto prec(get_rec(tbl, fnd->second));
+	patch(prec, rec);
+	update_row(tbl, prec, k);
+      }
+      
+      break;
+    default:
+      ERROR(Db, fmt("Invalid table operation: %0", op));
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void slurp(SlotTable<RecT, KeyT...> &tbl, std::istream &in) {
+    slurp_recs(tbl, in, [&tbl](uint8_t op, const Rec<RecT> &rec) {
+	replay(tbl, op, rec);
+      });
+  }
+
+  template <typename RecT, typename...KeyT>
+  void slurp(SlotTable<RecT, KeyT...> &tbl) {
+    slurp_file(tbl, [&tbl](uint8_t op, const Rec<RecT> &rec) {
+	replay(tbl, op, rec);
+      });
+  }
+
+  template <typename RecT, typename...KeyT>
+  void copy(SlotTable<RecT, KeyT...> &dest, const SlotTable<RecT, KeyT...> &src) {
+    for (auto &r: src.rows) {
+      if (dest.rows.find(r.first) == dest.rows.end()) {
+	insert_row(dest, r.first, get_rec(src, r.second));
+      }
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  SlotTable<RecT, KeyT...>::SlotTable(Ctx &ctx,
+				      const str &name,
+				      const Key &key,
+				      const Schema<RecT> &cols):
+    Index<RecT>(ctx, name, cols),
+    key(key)
+  {
+    for_each(key, [this](auto c) { add(*this, *c); });
+    resize(slots, this->col_slots.size());
+    ctx.tables.emplace(name, this);
+  }
+
+  template <typename RecT, typename...KeyT>
+  SlotTable<RecT, KeyT...>::~SlotTable() {
+    this->ctx.tables.erase(this->name);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SlotTable<RecT, KeyT...>::insert(const Rec<RecT> &rec) {
+    return db::insert(*this, rec);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SlotTable<RecT, KeyT...>::update(const Rec<RecT> &rec, const Rec<RecT> &key) {
+    return db::update(*this, rec, key);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SlotTable<RecT, KeyT...>::erase(const Rec<RecT> &rec) {
+    return db::erase(*this, rec);
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SlotTable<RecT, KeyT...>::dump(std::ostream &out) { db::dump(*this, out); }
+
+  template <typename RecT, typename...KeyT>
+  void SlotTable<RecT, KeyT...>::slurp() { db::slurp(*this); }
+
+  template <typename RecT, typename...KeyT>
+  opt<Compactor> SlotTable<RecT, KeyT...>::compactor() const {
+    return make_compactor(*this, key, this->ctx.secret);
+  }
+
+  template <typename RecT, typename...KeyT>
+  SlotChange<RecT, KeyT...>::SlotChange(TableOp op,
+					SlotTable<RecT, KeyT...> &table,
+					const Rec<RecT> &rec,
+					const Rec<RecT> &prev_rec):
+    op(op), table(table), rec(rec), prev_rec(prev_rec)
+  { }
+
+  template <typename RecT, typename...KeyT>
+  Path SlotChange<RecT, KeyT...>::table_path() const {
+    return table.path;
+  }
+
+  template <typename RecT, typename...KeyT>
+  int64_t SlotChange<RecT, KeyT...>::dead_recs() const {
+    switch (op) {
+    case TABLE_INSERT:
+      return 0;
+    case TABLE_UPDATE:
+    case TABLE_PATCH:
+      return 1;
+    default:
+      return 2;
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Compactor> SlotChange<RecT, KeyT...>::compactor() const {
+    return table.compactor();
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SlotChange<RecT, KeyT...>::write(Frame &out) const {
+    if (op == TABLE_UPDATE && table.key(rec) != table.key(prev_rec)) {
+      db::write(out, TABLE_ERASE, prev_rec);
+      db::write(out, TABLE_INSERT, rec);
+    } else {
+      db::write(out, op, rec);
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SlotChange<RecT, KeyT...>::apply(Ctx &ctx) const {
+    auto fnd(ctx.tables.find(table.name));
+    CHECK(fnd != ctx.tables.end(), _);
+    auto &tbl(*dynamic_cast<SlotTable<RecT, KeyT...> *>(fnd->second));
+
+    switch (op) {
+    case TABLE_INSERT:
+      if (!find_row(tbl, tbl.key(rec))) { insert_row(tbl, tbl.key(rec), rec); }
+      break;
+    case TABLE_UPDATE:
+      update_row(tbl, rec, tbl.key(prev_rec));
+      break;
+    case TABLE_ERASE: {
+      auto it(tbl.rows.find(tbl.key(rec)));
+      if (it != tbl.rows.end()) { erase_row(tbl, it); }
+      break;
+    }
+    case TABLE_PATCH: {
+      auto prec(patch_row(tbl, rec));
+      if (prec) { update_row(tbl, *prec, tbl.key(*prec)); }
+      break;
+    }
+    case TABLE_FRAME:
+      ERROR(Db, fmt("Invalid table operation: %0", op));
+      break;
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SlotChange<RecT, KeyT...>::rollback() const {
+    switch (op) {
+    case TABLE_INSERT: {
+      auto it(table.rows.find(table.key(rec)));
+      if (it != table.rows.end()) { erase_row(table, it); }
+      break;
+    }
+    case TABLE_UPDATE:
+      update_row(table, prev_rec, table.key(rec));
+      break;
+    case TABLE_ERASE:
+      insert_row(table, table.key(rec), rec);
+      break;
+    case TABLE_PATCH: {
+      auto prec(patch_row(table, prev_rec));
+      if (prec) { update_row(table, *prec, table.key(*prec)); }
+      break;
+    }
+    case TABLE_FRAME:
+      ERROR(Db, fmt("Invalid table operation: %0", op));
+      break;
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SlotChange<RecT, KeyT...>::undo() const {
+    switch (op) {
+    case TABLE_INSERT:
+      erase(table, rec);
+      break;
+    case TABLE_UPDATE:
+      update(table, prev_rec, rec);
+      break;
+    case TABLE_ERASE:
+      insert(table, rec);
+      break;
+    case TABLE_PATCH: {
+      auto prec(patch_row(table, prev_rec));
+      if (prec) { update(table, *prec); }
+      break;
+    }
+    case TABLE_FRAME:
+      ERROR(Db, fmt("Invalid table operation: %0", op));
+      break;
+    }
+  }
+}}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef SNACKIS_DB_SLOTS_HPP
+#define SNACKIS_DB_SLOTS_HPP
+
+#include <bitset>
+#include <vector>
+
+#include "snackis/core/error.hpp"
+#include "snackis/core/val.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/schema.hpp"
+
+namespace snackis {
+namespace db {
+  const size_t MAX_SLOTS(64);
+  using SlotMask = std::bitset<MAX_SLOTS>;
+
+  template <typename RecT>
+  struct Slots {
+    std::vector<std::vector<Val>> cols;
+    std::vector<SlotMask> masks;
+    std::vector<size_t> free_rows;
+  };
+
+  template <typename RecT>
+  void resize(Slots<RecT> &s, size_t width) {
+    CHECK(width <= MAX_SLOTS, _);
+    s.cols.resize(width, std::vector<Val>(s.masks.size()));
+  }
+
+  template <typename RecT>
+  size_t add_row(Slots<RecT> &s) {
+    if (!s.free_rows.empty()) {
+      auto row(s.free_rows.back());
+      s.free_rows.pop_back();
+      return row;
+    }
+
+    auto row(s.masks.size());
+    s.masks.emplace_back();
+    for (auto &c: s.cols) { c.emplace_back(); }
+    return row;
+  }
+
+  template <typename RecT>
+  void drop_row(Slots<RecT> &s, size_t row) {
+    for (auto &c: s.cols) { c[row] = Val(); }
+    s.masks[row].reset();
+    s.free_rows.push_back(row);
+  }
+
+  template <typename RecT>
+  size_t row_count(const Slots<RecT> &s) {
+    return s.masks.size()-s.free_rows.size();
+  }
+
+  template <typename RecT>
+  const Val *get(const Slots<RecT> &s, size_t row, size_t slot) {
+    return s.masks[row].test(slot) ? &s.cols[slot][row] : nullptr;
+  }
+
+  template <typename RecT>
+  void set(Slots<RecT> &s, size_t row, size_t slot, const Val &val) {
+    s.cols[slot][row] = val;
+    s.masks[row].set(slot);
+  }
+
+  template <typename RecT>
+  void clear(Slots<RecT> &s, size_t row) {
+    for (size_t i(0); i < s.cols.size(); i++) {
+      if (s.masks[row].test(i)) { s.cols[i][row] = Val(); }
+    }
+
+    s.masks[row].reset();
+  }
+
+  template <typename RecT>
+  int compare(const Slots<RecT> &s, size_t x, size_t y) {
+    auto &xm(s.masks[x]), &ym(s.masks[y]);
+
+    for (size_t i(0); i < s.cols.size(); i++) {
+      if (!xm.test(i) && !ym.test(i)) { continue; }
+      if (!xm.test(i)) { return 1; }
+      if (!ym.test(i)) { return -1; }
+
+      auto &c(s.cols[i]);
+      if (c[x] < c[y]) { return -1; }
+      if (c[y] < c[x]) { return 1; }
+    }
+
+    return 0;
+  }
+
+  template <typename RecT>
+  int compare(const Schema<RecT> &scm,
+	      const Slots<RecT> &s, size_t row,
+	      const Rec<RecT> &rec) {
+    auto yi(rec.begin());
+    
+    for (auto &cs: scm.col_slots) {
+      while (yi != rec.end() && yi->first < cs.first) { yi++; }
+      auto xv(get(s, row, cs.second));
+      const bool yv(yi != rec.end() && yi->first == cs.first);
+
+      if (!xv && !yv) { continue; }
+      if (!xv) { return 1; }
+      if (!yv) { return -1; }
+
+      if (*xv < yi->second) { return -1; }
+      if (yi->second < *xv) { return 1; }
+    }
+
+    return 0;
+  }
+
+  template <typename RecT>
+  void copy(const Schema<RecT> &scm,
+	    Slots<RecT> &dest, size_t row,
+	    const Rec<RecT> &src) {
+    auto cs(scm.col_slots.begin());
+    
+    for (auto &f: src) {
+      while (cs != scm.col_slots.end() && cs->first < f.first) { cs++; }
+      if (cs == scm.col_slots.end()) { break; }
+      if (cs->first == f.first) { set(dest, row, cs->second, f.second); }
+    }
+  }
+
+  template <typename RecT>
+  void copy(const Schema<RecT> &scm,
+	    Rec<RecT> &dest,
+	    const Slots<RecT> &src, size_t row) {
+    for (auto &cs: scm.col_slots) {
+      auto v(get(src, row, cs.second));
+      if (v) { dest.insert_or_assign(dest.end(), cs.first, *v); }
+    }
+  }
+
+  template <typename RecT>
+  void copy(const Schema<RecT> &scm,
+	    RecT &dest,
+	    const Slots<RecT> &src, size_t row) {
+    for (auto &cs: scm.col_slots) {
+      auto v(get(src, row, cs.second));
+      if (v) { cs.first->set(dest, *v); }
+    }
+  }
+}}
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef SNACKIS_DB_SLURP_HPP
+#define SNACKIS_DB_SLURP_HPP
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "snackis/core/chan.hpp"
+#include "snackis/core/data.hpp"
+#include "snackis/core/buf.hpp"
+#include "snackis/core/int64_type.hpp"
+#include "snackis/core/mmap.hpp"
+#include "snackis/core/path.hpp"
+#include "snackis/core/pool.hpp"
+#include "snackis/core/stream.hpp"
+#include "snackis/crypt/secret.hpp"
+#include "snackis/db/checkpoint.hpp"
+#include "snackis/db/ctx.hpp"
+#include "snackis/db/error.hpp"
+#include "snackis/db/frame.hpp"
+#include "snackis/db/index.hpp"
+#include "snackis/db/rec.hpp"
+
+namespace snackis {
+namespace db {
+  const size_t
+    SLURP_BATCH(256),
+    SLURP_DEPTH(4);
+  
+  template <typename RecT>
+  struct SlurpBatch {
+    std::vector<uint8_t> ops;
+    std::vector<Data> data;
+    std::vector<std::pair<const unsigned char *, size_t>> spans;
+    std::vector<std::pair<uint8_t, Rec<RecT>>> recs;
+    std::deque<Error *> errors;
+    Chan<bool> done;
+
+    SlurpBatch();
+  };
+
+  template <typename RecT>
+  SlurpBatch<RecT>::SlurpBatch():
+    done(1)
+  {
+    data.reserve(SLURP_BATCH);
+  }
+
+  template <typename RecT>
+  bool read_op(Index<RecT> &tbl, std::istream &in, uint8_t &op) {
+    in.read(reinterpret_cast<char *>(&op), sizeof op);
+
+    if (in.eof()) {
+      in.clear();
+      return false;
+    }
+
+    if (in.fail()) {
+      in.clear();
+      ERROR(Db, fmt("Failed reading: %0", tbl.name));
+      return false;
+    }
+
+    return true;
+  }
+
+  template <typename RecT>
+  bool read_op(Index<RecT> &tbl, Buf &in, uint8_t &op) {
+    if (eof(in)) { return false; }
+    op = *take(in, 1);
+    return true;
+  }
+
+  template <typename RecT>
+  bool read_failed(Index<RecT> &tbl,
+		   std::istream &in,
+		   int64_t start,
+		   opt<int64_t> &torn) {
+    if (in.eof()) {
+      torn = start;
+    } else {
+      ERROR(Db, fmt("Failed reading: %0", tbl.name));
+    }
+
+    in.clear();
+    return false;
+  }
+
+  template <typename RecT>
+  bool read_failed(Index<RecT> &tbl,
+		   Buf &in,
+		   int64_t start,
+		   opt<int64_t> &torn) {
+    // Only reads running past the end count as torn, see slurp_file
+    if (in.short_read) {
+      torn = start;
+    } else {
+      ERROR(Db, fmt("Failed reading: %0", tbl.name));
+    }
+
+    return false;
+  }
+
+  template <typename RecT>
+  bool read_batch(Index<RecT> &tbl,
+		  std::istream &in,
+		  SlurpBatch<RecT> &b,
+		  opt<int64_t> &torn) {
+    uint8_t op;
+    
+    while (b.ops.size() < SLURP_BATCH) {
+      const int64_t start(in.tellg());
+      if (!read_op(tbl, in, op)) { return false; }
+      Data edata;
+      if (!read_frame(in, edata)) { return read_failed(tbl, in, start, torn); }
+      b.ops.push_back(op);
+      b.data.push_back(std::move(edata));
+      b.spans.emplace_back(b.data.back().data(), b.data.back().size());
+    }
+
+    return true;
+  }
+
+  template <typename RecT>
+  bool read_batch(Index<RecT> &tbl,
+		  Buf &in,
+		  SlurpBatch<RecT> &b,
+		  opt<int64_t> &torn) {
+    uint8_t op;
+    
+    while (b.ops.size() < SLURP_BATCH) {
+      const int64_t start(offset(in));
+      if (!read_op(tbl, in, op)) { return false; }
+      size_t len(0);
+      auto edata(read_frame(in, len));
+      if (!edata) { return read_failed(tbl, in, start, torn); }
+      b.ops.push_back(op);
+      b.spans.emplace_back(edata, len);
+    }
+
+    return true;
+  }
+
+  template <typename RecT, typename FnT>
+  void decode(Index<RecT> &tbl,
+	      uint8_t op,
+	      const unsigned char *edata, size_t len,
+	      FnT fn) {
+    auto &sec(*tbl.ctx.secret);
+
+    if (op == TABLE_FRAME) {
+      open_frame(tbl, sec, edata, len, fn);
+      return;
+    }
+    
+    TRY(try_decode);
+    const Data ddata(decrypt(sec, edata, len));
+    if (!try_decode.errors.empty()) { return; }
+    auto beg(reinterpret_cast<const char *>(ddata.data()));
+    Buf buf(beg, beg+ddata.size());
+    Rec<RecT> rec;
+    read(tbl, buf, rec);
+
+    if (buf.fail) {
+      ERROR(Db, fmt("Failed reading: %0", tbl.name));
+      return;
+    }
+    
+    fn(op, rec);
+  }
+  
+  template <typename RecT>
+  void decode(Index<RecT> &tbl, SlurpBatch<RecT> &b) {
+    TRY(try_decode);
+    
+    for (size_t i(0); i < b.spans.size(); i++) {
+      auto &s(b.spans[i]);
+      
+      decode(tbl, b.ops[i], s.first, s.second,
+	     [&b](uint8_t op, const Rec<RecT> &rec) {
+	       b.recs.emplace_back(op, rec);
+	     });
+    }
+
+    std::move(try_decode.errors.begin(), try_decode.errors.end(),
+	      std::back_inserter(b.errors));
+    try_decode.errors.clear();
+  }
+
+  template <typename RecT, typename FnT>
+  void deliver(SlurpBatch<RecT> &b, FnT fn) {
+    for (auto e: b.errors) { throw_error(e); }
+	
+    for (auto &r: b.recs) {
+      if (!r.second.empty()) { fn(r.first, r.second); }
+    }
+  }
+  
+  template <typename RecT, typename FnT>
+  opt<int64_t> slurp_plain(Index<RecT> &tbl, std::istream &in, FnT fn) {
+    opt<int64_t> torn;
+    uint8_t op;
+    
+    while (true) {
+      const int64_t start(in.tellg());
+      if (!read_op(tbl, in, op)) { break; }
+      
+      if (op == TABLE_FRAME) {
+	ERROR(Db, fmt("Missing secret for encrypted frame: %0", tbl.name));
+	break;
+      }
+      
+      Rec<RecT> rec;
+      read(tbl, in, rec, nullopt);
+      if (op == TABLE_PATCH) { read_erased(tbl, in, rec); }
+      if (in.fail()) { read_failed(tbl, in, start, torn); break; }
+      fn(op, rec);
+    }
+
+    return torn;
+  }
+
+  template <typename RecT, typename FnT>
+  opt<int64_t> slurp_plain(Index<RecT> &tbl, Buf &in, FnT fn) {
+    opt<int64_t> torn;
+    uint8_t op;
+    
+    while (true) {
+      const int64_t start(offset(in));
+      if (!read_op(tbl, in, op)) { break; }
+      
+      if (op == TABLE_FRAME) {
+	ERROR(Db, fmt("Missing secret for encrypted frame: %0", tbl.name));
+	break;
+      }
+      
+      Rec<RecT> rec;
+      read(tbl, in, rec);
+      if (op == TABLE_PATCH) { read_erased(tbl, in, rec); }
+      if (in.fail) { read_failed(tbl, in, start, torn); break; }
+      fn(op, rec);
+    }
+
+    return torn;
+  }
+
+  template <typename RecT, typename InT, typename FnT>
+  opt<int64_t> slurp_recs(Index<RecT> &tbl, InT &in, FnT fn) {
+    if (!tbl.ctx.secret) { return slurp_plain(tbl, in, fn); }
+    auto pool(tbl.ctx.slurp_pool);
+    opt<int64_t> torn;
+    
+    if (!pool) {
+      bool more(true);
+      
+      while (more) {
+	SlurpBatch<RecT> b;
+	more = read_batch(tbl, in, b, torn);
+	decode(tbl, b);
+	deliver(b, fn);
+      }
+
+      return torn;
+    }
+
+    std::deque<std::shared_ptr<SlurpBatch<RecT>>> pending;
+    bool more(true);
+    
+    while (more || !pending.empty()) {
+      if (more) {
+	auto b(std::make_shared<SlurpBatch<RecT>>());
+	more = read_batch(tbl, in, *b, torn);
+
+	if (!b->ops.empty()) {
+	  post(*pool, [&tbl, b]() {
+	      decode(tbl, *b);
+	      put(b->done, true);
+	    });
+	  
+	  pending.push_back(b);
+	}
+      }
+
+      if (!pending.empty() && (!more || pending.size() == SLURP_DEPTH)) {
+	auto b(pending.front());
+	pending.pop_front();
+	get(b->done);
+	deliver(*b, fn);
+      }
+    }
+
+    return torn;
+  }
+
+  inline bool save_tail(const Path &in_path, int64_t start, const Path &out_path) {
+    std::ifstream in(in_path.string(), std::ios::in | std::ios::binary);
+    in.seekg(start);
+    std::ofstream out(out_path.string(),
+		      std::ios::out | std::ios::binary | std::ios::app);
+    if (in.fail() || out.fail()) { return false; }
+    out << in.rdbuf();
+    out.close();
+    return !out.fail();
+  }
+  
+  template <typename RecT, typename FnT>
+  void slurp_file(Index<RecT> &tbl, FnT fn) {
+    const Path chk_path(checkpoint_path(tbl.path));
+    int64_t start(0);
+    
+    if (path_exists(chk_path)) {
+      MMap chk(chk_path);
+      Buf in(get_buf(chk));
+      auto end(chk.fail ? nullopt : read_checkpoint(in, tbl.path));
+
+      if (end) {
+	slurp_recs(tbl, in, fn);
+	start = *end;
+      } else {
+	tbl.slurp_log.push_back(fmt("Ignoring invalid checkpoint: %0",
+				    chk_path.string()));
+      }
+    }
+
+    opt<int64_t> torn;
+    
+    {
+      MMap f(tbl.path);
+      
+      if (f.fail) {
+	ERROR(Db, fmt("Failed opening file: %0", tbl.name));
+	return;
+      }
+
+      Buf in(get_buf(f));
+      take(in, start);
+      torn = slurp_recs(tbl, in, fn);
+    }
+    
+    if (torn) {
+      // Corrupt lengths look torn as well, the tail is kept for recovery
+      const Path bak(tbl.path.string() + ".torn");
+      
+      if (!save_tail(tbl.path, *torn, bak)) {
+	ERROR(Db, fmt("Failed saving torn tail: %0", bak.string()));
+	return;
+      }
+      
+      tbl.slurp_log.push_back(fmt("Truncating torn record in %0 at offset %1, "
+				  "tail saved to %2",
+				  tbl.name, *torn, bak.string()));
+      std::error_code err;
+      stdfs::resize_file(tbl.path, *torn, err);
+
+      if (err) {
+	ERROR(Db, fmt("Failed truncating file: %0", tbl.path.string()));
+      }
+    }
+  }
+}}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef SNACKIS_DB_SORT_INDEX_HPP
+#define SNACKIS_DB_SORT_INDEX_HPP
+
+#include <map>
+
+#include "snackis/core/tuple.hpp"
+#include "snackis/db/index.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/rec.hpp"
+
+namespace snackis {
+namespace db {
+  template <typename RecT, typename...KeyT>
+  struct SortIndex: Index<RecT> {
+    using Key = db::Key<RecT, KeyT...>;
+    using Recs = std::map<typename Key::Type, const Rec<RecT> *, PrefixLess>;
+    using RecIter = typename Recs::const_iterator;
+
+    const Key key;
+    Recs recs;
+
+    SortIndex(Ctx &ctx, const str &name, const Key &key);
+
+    bool insert(const Rec<RecT> &rec) override;
+    bool update(const Rec<RecT> &rec, const Rec<RecT> &prev) override;
+    bool erase(const Rec<RecT> &rec) override;
+
+    void dump(std::ostream &out) override;
+    void slurp() override;
+  };
+
+  template <typename RecT, typename...KeyT, typename...PrefixT>
+  typename SortIndex<RecT, KeyT...>::RecIter
+  lower_bound(const SortIndex<RecT, KeyT...> &idx,
+	      const std::tuple<PrefixT...> &prefix) {
+    return idx.recs.lower_bound(prefix);
+  }
+
+  template <typename RecT, typename...KeyT, typename...PrefixT>
+  typename SortIndex<RecT, KeyT...>::RecIter
+  upper_bound(const SortIndex<RecT, KeyT...> &idx,
+	      const std::tuple<PrefixT...> &prefix) {
+    return idx.recs.upper_bound(prefix);
+  }
+
+  template <typename RecT, typename...KeyT>
+  SortIndex<RecT, KeyT...>::SortIndex(Ctx &ctx, const str &name, const Key &key):
+    Index<RecT>(ctx, name, {}),
+    key(key)
+  {
+    for_each(key, [this](auto c) { add(*this, *c); });
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SortIndex<RecT, KeyT...>::insert(const Rec<RecT> &rec) {
+    return recs.emplace(key(rec), &rec).second;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SortIndex<RecT, KeyT...>::update(const Rec<RecT> &rec,
+					const Rec<RecT> &prev) {
+    recs.erase(key(prev));
+    return insert(rec);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool SortIndex<RecT, KeyT...>::erase(const Rec<RecT> &rec) {
+    return recs.erase(key(rec)) > 0;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void SortIndex<RecT, KeyT...>::dump(std::ostream &out) { }
+
+  template <typename RecT, typename...KeyT>
+  void SortIndex<RecT, KeyT...>::slurp() { }
+}}
+
+#endif
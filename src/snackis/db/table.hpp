@@ -2,6 +2,7 @@
 #define SNACKIS_DB_TABLE_HPP
 
 #include <cstdint>
+#include <memory>
 #include <set>
 
 #include "snackis/core/data.hpp"
@@ -14,10 +15,13 @@
 #include "snackis/core/stream.hpp"
 #include "snackis/crypt/secret.hpp"
 #include "snackis/db/change.hpp"
+#include "snackis/db/compact.hpp"
 #include "snackis/db/ctx.hpp"
 #include "snackis/db/error.hpp"
+#include "snackis/db/frame.hpp"
 #include "snackis/db/index.hpp"
 #include "snackis/db/rec.hpp"
+#include "snackis/db/slurp.hpp"
 #include "snackis/db/trans.hpp"
 
 namespace snackis {  
@@ -29,14 +33,16 @@ namespace db {
   struct Table: Index<RecT> {
     using Key = db::Key<RecT, KeyT...>;
     using Cols = std::initializer_list<const BasicCol<RecT> *>;
-    using Recs = std::map<typename Key::Type, Rec<RecT>>;
+    using Row = std::shared_ptr<Rec<RecT>>;
+    using Recs = std::map<typename Key::Type, Row>;
     using RecIter = typename Recs::iterator;
     using OnInsert = func<void (Rec<RecT> &)>;
     using OnUpdate = func<void (const Rec<RecT> &, Rec<RecT> &)>;
     
     const Key key;
     std::set<Index<RecT> *> indexes;
-    Recs recs;
+    // Shared with snapshots, copied by the first write while shared
+    std::shared_ptr<Recs> recs;
     std::vector<OnInsert> on_insert;
     std::vector<OnUpdate> on_update;
     
@@ -52,10 +58,9 @@ namespace db {
 
     void dump(std::ostream &out) override;
     void slurp() override;
+    opt<Compactor> compactor() const override;
   };
     
-  enum TableOp {TABLE_INSERT, TABLE_UPDATE, TABLE_ERASE};
-
   template <typename RecT, typename...KeyT>
   struct TableChange: Change {
     TableOp op;
@@ -64,7 +69,9 @@ namespace db {
 
     TableChange(TableOp op, Table<RecT, KeyT...> &table, const Rec<RecT> &rec);
     Path table_path() const override;
-    virtual void write(std::ostream &out) const override;
+    virtual void write(Frame &out) const override;
+    int64_t dead_recs() const override;
+    opt<Compactor> compactor() const override;
   };
 
   template <typename RecT, typename...KeyT>
@@ -81,10 +88,11 @@ namespace db {
     Update(Table<RecT, KeyT...> &table,
 	   const Rec<RecT> &rec,
 	   const Rec<RecT> &prev_rec);    
+    Update(Table<RecT, KeyT...> &table, const Patch<RecT> &patch);    
     void apply(Ctx &ctx) const override;
     void rollback() const override;
     void undo() const override;
-    void write(std::ostream &out) const override;
+    void write(Frame &out) const override;
   };
 
   template <typename RecT, typename...KeyT>
@@ -98,27 +106,27 @@ namespace db {
   template <typename RecT, typename...KeyT>
   opt<RecT> load(Table<RecT, KeyT...> &tbl, RecT &rec) {
     auto k(tbl.key(rec));
-    auto it(tbl.recs.find(k));
-    if (it == tbl.recs.end()) { return nullopt; }
-    copy(tbl, rec, it->second);
+    auto it(tbl.recs->find(k));
+    if (it == tbl.recs->end()) { return nullopt; }
+    copy(tbl, rec, *it->second);
     return rec;
   }
 
   template <typename RecT, typename...KeyT>
   opt<Rec<RecT>> load(Table<RecT, KeyT...> &tbl, Rec<RecT> &rec) {
     auto k(tbl.key(rec));
-    auto it(tbl.recs.find(k));
-    if (it == tbl.recs.end()) { return nullopt; }
-    copy(tbl, rec, it->second);
+    auto it(tbl.recs->find(k));
+    if (it == tbl.recs->end()) { return nullopt; }
+    copy(tbl, rec, *it->second);
     return rec;
   }
 
   template <typename RecT, typename...KeyT>
   const Rec<RecT> *find(Table<RecT, KeyT...> &tbl,
 			const typename Key<RecT, KeyT...>::Type &key) {
-    auto it(tbl.recs.find(key));
-    if (it == tbl.recs.end()) { return nullptr; }
-    return &it->second;
+    auto it(tbl.recs->find(key));
+    if (it == tbl.recs->end()) { return nullptr; }
+    return it->second.get();
   }
 
   template <typename RecT, typename...KeyT>
@@ -131,12 +139,20 @@ namespace db {
     return find(tbl, tbl.key(rec));
   }
 
+  template <typename RecT, typename...KeyT>
+  typename Table<RecT, KeyT...>::Row get_row(const Table<RecT, KeyT...> &tbl,
+					     const Rec<RecT> &rec) {
+    auto it(tbl.recs->find(tbl.key(rec)));
+    CHECK(it != tbl.recs->end(), _);
+    return it->second;
+  }
+
   template <typename RecT, typename...KeyT>
   const Rec<RecT> &get(Table<RecT, KeyT...> &tbl,
 		       const typename Key<RecT, KeyT...>::Type &key) {
-    auto it(tbl.recs.find(key));
-    CHECK(it != tbl.recs.end(), _);
-    return it->second;
+    auto it(tbl.recs->find(key));
+    CHECK(it != tbl.recs->end(), _);
+    return *it->second;
   }
 
   template <typename RecT, typename...KeyT>
@@ -149,21 +165,56 @@ namespace db {
     return get(tbl, tbl.key(rec));
   }
 
+  template <typename RecT, typename...KeyT>
+  typename Table<RecT, KeyT...>::Recs &own_recs(Table<RecT, KeyT...> &tbl) {
+    using Recs = typename Table<RecT, KeyT...>::Recs;
+    
+    if (tbl.recs.use_count() > 1) {
+      tbl.recs = std::make_shared<Recs>(*tbl.recs);
+    }
+    
+    return *tbl.recs;
+  }
+
+  template <typename RecT, typename...KeyT>
+  typename Table<RecT, KeyT...>::RecIter
+  insert_rec(Table<RecT, KeyT...> &tbl,
+	     const typename Key<RecT, KeyT...>::Type &key,
+	     const Rec<RecT> &rec) {
+    auto res(own_recs(tbl).emplace(key, nullptr));
+    if (!res.second) { return res.first; }
+    auto &row(res.first->second);
+    row = std::make_shared<Rec<RecT>>();
+    copy(tbl, *row, rec);
+    for (auto idx: tbl.indexes) { insert(*idx, *row); }
+    return res.first;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void erase_rec(Table<RecT, KeyT...> &tbl,
+		 typename Table<RecT, KeyT...>::RecIter it) {
+    for (auto idx: tbl.indexes) { erase(*idx, *it->second); }
+    own_recs(tbl).erase(it);
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool erase_rec(Table<RecT, KeyT...> &tbl,
+		 const typename Key<RecT, KeyT...>::Type &key) {
+    auto &recs(own_recs(tbl));
+    auto it(recs.find(key));
+    if (it == recs.end()) { return false; }
+    erase_rec(tbl, it);
+    return true;
+  }
+
   template <typename RecT, typename...KeyT>
   bool insert(Table<RecT, KeyT...> &tbl, const Rec<RecT> &rec) {
     TRACE(fmt("Inserting into table: %0", tbl.name));
     auto k(tbl.key(rec));
-    auto it(tbl.recs.find(k));
-    if (it != tbl.recs.end()) { return false; }
-
-    for (auto idx: tbl.indexes) {
-      insert(*idx, rec);
-    }
-
-    it = tbl.recs.emplace(k, db::Rec<RecT>()).first;
-    copy(tbl, it->second, rec);
-    for (auto e: tbl.on_insert) { e(it->second); }
-    log_change(get_trans(tbl.ctx), new Insert<RecT, KeyT...>(tbl, it->second));
+    if (tbl.recs->find(k) != tbl.recs->end()) { return false; }
+    auto it(insert_rec(tbl, k, rec));
+    for (auto e: tbl.on_insert) { e(*it->second); }
+    log_change(get_trans(tbl.ctx), new Insert<RecT, KeyT...>(tbl, *it->second));
     return true;
   }
 
@@ -172,30 +223,45 @@ namespace db {
     return insert(tbl, db::Rec<RecT>(tbl, rec));
   }
 
+  template <typename RecT, typename...KeyT>
+  opt<Rec<RecT>> patch_rec(Table<RecT, KeyT...> &tbl, const Rec<RecT> &patch) {
+    auto it(tbl.recs->find(tbl.key(patch)));
+    if (it == tbl.recs->end()) { return nullopt; }
+    Rec<RecT> out(*it->second);
+    db::patch(out, patch);
+    return out;
+  }
+
   template <typename RecT, typename...KeyT>
   opt<std::pair<typename Table<RecT, KeyT...>::RecIter, db::Rec<RecT>>>
   update_rec(Table<RecT, KeyT...> &tbl,
 	     const Rec<RecT> &rec,
 	     const typename Key<RecT, KeyT...>::Type &key) {
     TRACE(fmt("Updating table: %0", tbl.name));
-    auto it(tbl.recs.find(key));
+    auto fnd(tbl.recs->find(key));
 
-    if (it == tbl.recs.end() || compare(tbl, rec, it->second) == 0) {
+    if (fnd == tbl.recs->end() || compare(tbl, rec, *fnd->second) == 0) {
       return nullopt;
     }
     
-    auto prev(it->second);
+    auto &recs(own_recs(tbl));
+    auto it(recs.find(key));
+    auto prev(*it->second);
     auto rec_key(tbl.key(rec));
+    auto row(std::make_shared<Rec<RecT>>());
+    copy(tbl, *row, rec);
     
     if (rec_key == key) {
-      it->second.clear();
-      copy(tbl, it->second, rec);
+      it->second = row;
     } else {
-      tbl.recs.erase(it);
-      it = tbl.recs.emplace(rec_key, db::Rec<RecT>()).first;
-      copy(tbl, it->second, rec);
+      // Updated rec replaces any row already stored under its key
+      auto dup(recs.find(rec_key));
+      if (dup != recs.end()) { erase_rec(tbl, dup); }
+      recs.erase(it);
+      it = recs.emplace(rec_key, row).first;
     }
 
+    for (auto idx: tbl.indexes) { update(*idx, *it->second, prev); }
     return make_pair(it, prev);
   }
   
@@ -206,9 +272,8 @@ namespace db {
     auto res(update_rec(tbl, rec, key));
     if (!res) { return false; }
     auto [it, prev] = *res;
-    for (auto idx: tbl.indexes) { update(*idx, rec, prev); }
-    for (auto e: tbl.on_update) { e(prev, it->second); }
-    log_change(get_trans(tbl.ctx), new Update<RecT, KeyT...>(tbl, it->second, prev));
+    for (auto e: tbl.on_update) { e(prev, *it->second); }
+    log_change(get_trans(tbl.ctx), new Update<RecT, KeyT...>(tbl, *it->second, prev));
     return true;
   }
 
@@ -244,11 +309,11 @@ namespace db {
   bool erase(Table<RecT, KeyT...> &tbl,
 	     const typename Key<RecT, KeyT...>::Type &key) {
     TRACE(fmt("Erasing from table: %0", tbl.name));
-    auto it(tbl.recs.find(key));
-    if (it == tbl.recs.end()) { return false; }
-    log_change(get_trans(tbl.ctx), new Erase<RecT, KeyT...>(tbl, it->second));
-    for (auto idx: tbl.indexes) { erase(*idx, it->second); }
-    tbl.recs.erase(it);
+    auto &recs(own_recs(tbl));
+    auto it(recs.find(key));
+    if (it == recs.end()) { return false; }
+    log_change(get_trans(tbl.ctx), new Erase<RecT, KeyT...>(tbl, *it->second));
+    erase_rec(tbl, it);
     return true;
   }
 
@@ -267,79 +332,71 @@ namespace db {
     return erase(tbl, tbl.key(rec));
   }
 
-  template <typename RecT, typename...KeyT>
-  void write(Table<RecT, KeyT...> &tbl, TableOp _op,
-	     const Rec<RecT> &rec,
-	     std::ostream &out) {
-    uint8_t op(_op);
-    out.write(reinterpret_cast<const char *>(&op), sizeof op);
-    write(rec, out, tbl.ctx.secret);
-  }
-
   template <typename RecT, typename...KeyT>
   void dump(Table<RecT, KeyT...> &tbl, std::ostream &out) {    
-    for (auto &rec: tbl.recs) {
-      write(tbl, TABLE_INSERT, rec.second, out);
-    }
+    crypt::Nonce nonce;
+    Frame f(out, tbl.ctx.secret, nonce);
+    for (auto &rec: *tbl.recs) { write(f, TABLE_INSERT, *rec.second); }
+    seal(f);
   }
 
   template <typename RecT, typename...KeyT>
-  void slurp(Table<RecT, KeyT...> &tbl, std::istream &in) {    
-    while (true) {
-      uint8_t op;
-      in.read(reinterpret_cast<char *>(&op), sizeof op);
-
-      if (in.eof()) {
-	in.clear();
-	break;
-      }
+  void replay(Table<RecT, KeyT...> &tbl, uint8_t op, const Rec<RecT> &rec) {
+    auto k(tbl.key(rec));
 
-      if (in.fail()) {
-	in.clear();
-	ERROR(Db, fmt("Failed reading: %0", tbl.name));
-      }
-            
-      Rec<RecT> rec;
-      read(tbl, in, rec, tbl.ctx.secret);
-
-      switch (op) {
-      case TABLE_INSERT:
-	tbl.recs.emplace(tbl.key(rec), rec);
-	break;
-      case TABLE_UPDATE: {
-	auto k(tbl.key(rec));
-	tbl.recs.erase(k);
-	tbl.recs.emplace(k, rec);
-	break;
-      }
-      case TABLE_ERASE:
-	tbl.recs.erase(tbl.key(rec));
-	break;
-      default:
-	log(tbl.ctx, fmt("Invalid table operation: %0", op));
+    switch (op) {
+    case TABLE_INSERT:
+      insert_rec(tbl, k, rec);
+      break;
+    case TABLE_UPDATE:
+      erase_rec(tbl, k);
+      insert_rec(tbl, k, rec);
+      break;
+    case TABLE_ERASE:
+      erase_rec(tbl, k);
+      break;
+    case TABLE_PATCH: {
+      auto prec(patch_rec(tbl, rec));
+      
+      if (prec) {
+	erase_rec(tbl, k);
+	insert_rec(tbl, k, *prec);
       }
+      
+      break;
+    }
+    default:
+      ERROR(Db, fmt("Invalid table operation: %0", op));
     }
   }
+  
+  template <typename RecT, typename...KeyT>
+  void slurp(Table<RecT, KeyT...> &tbl, std::istream &in) {
+    slurp_recs(tbl, in, [&tbl](uint8_t op, const Rec<RecT> &rec) {
+	replay(tbl, op, rec);
+      });
+  }
 
   template <typename RecT, typename...KeyT>
   void slurp(Table<RecT, KeyT...> &tbl) {
-    std::fstream f;
-    
-    f.open(get_path(tbl.ctx, tbl.name + ".tbl").string(),
-	      std::ios::in | std::ios::binary);
-    if (f.fail()) {
-      ERROR(Db, fmt("Failed opening file: %0", tbl.name));
-      return;
-    }
-
-    slurp(tbl, f);
-    f.close();
+    slurp_file(tbl, [&tbl](uint8_t op, const Rec<RecT> &rec) {
+	replay(tbl, op, rec);
+      });
   }
 
   template <typename RecT, typename...KeyT>
   void copy(Table<RecT, KeyT...> &dest, const Table<RecT, KeyT...> &src) {
-    std::copy(src.recs.begin(), src.recs.end(),
-	      std::inserter(dest.recs, dest.recs.end()));
+    for (auto &r: *src.recs) { insert_rec(dest, r.first, *r.second); }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void snapshot(Table<RecT, KeyT...> &dest, const Table<RecT, KeyT...> &src) {
+    CHECK(dest.recs->empty(), _);
+    dest.recs = src.recs;
+
+    for (auto &r: *dest.recs) {
+      for (auto idx: dest.indexes) { insert(*idx, *r.second); }
+    }
   }
   
   template <typename RecT, typename...KeyT>
@@ -348,7 +405,8 @@ namespace db {
 			      const Key &key,
 			      const Schema<RecT> &cols):
     Index<RecT>(ctx, name, cols),
-    key(key)
+    key(key),
+    recs(std::make_shared<Recs>())
   {
     for_each(key, [this](auto c) { add(*this, *c); });
     ctx.tables.emplace(name, this);
@@ -380,6 +438,11 @@ namespace db {
   template <typename RecT, typename...KeyT>
   void Table<RecT, KeyT...>::slurp() { db::slurp(*this); }
 
+  template <typename RecT, typename...KeyT>
+  opt<Compactor> Table<RecT, KeyT...>::compactor() const {
+    return make_compactor(*this, key, this->ctx.secret);
+  }
+
   template <typename RecT, typename...KeyT>
   TableChange<RecT, KeyT...>::TableChange(TableOp op,
 					  Table<RecT, KeyT...> &table,
@@ -393,8 +456,26 @@ namespace db {
   }
 
   template <typename RecT, typename...KeyT>
-  void TableChange<RecT, KeyT...>::write(std::ostream &out) const {
-    db::write(this->table, this->op, this->rec, out);
+  void TableChange<RecT, KeyT...>::write(Frame &out) const {
+    db::write(out, this->op, this->rec);
+  }
+
+  template <typename RecT, typename...KeyT>
+  int64_t TableChange<RecT, KeyT...>::dead_recs() const {
+    switch (op) {
+    case TABLE_INSERT:
+      return 0;
+    case TABLE_UPDATE:
+    case TABLE_PATCH:
+      return 1;
+    default:
+      return 2;
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  opt<Compactor> TableChange<RecT, KeyT...>::compactor() const {
+    return table.compactor();
   }
 
   template <typename RecT, typename...KeyT>
@@ -405,12 +486,12 @@ namespace db {
   template <typename RecT, typename...KeyT>
   void Insert<RecT, KeyT...>::apply(Ctx &ctx) const {
     auto &tbl(get_table<RecT, KeyT...>(ctx, this->table.name));
-    tbl.recs.emplace(tbl.key(this->rec), this->rec);
+    insert_rec(tbl, tbl.key(this->rec), this->rec);
   }
 
   template <typename RecT, typename...KeyT>
   void Insert<RecT, KeyT...>::rollback() const {
-    this->table.recs.erase(this->table.key(this->rec));
+    erase_rec(this->table, this->table.key(this->rec));
   }
 
   template <typename RecT, typename...KeyT>
@@ -422,33 +503,55 @@ namespace db {
   Update<RecT, KeyT...>::Update(Table<RecT, KeyT...> &table,
 				const Rec<RecT> &rec,
 				const Rec<RecT> &prev_rec):
-    TableChange<RecT, KeyT...>(TABLE_UPDATE, table, rec),
-    prev_rec(prev_rec)
+    Update(table, make_patch(table.key, rec, prev_rec))
+  { }
+
+  template <typename RecT, typename...KeyT>
+  Update<RecT, KeyT...>::Update(Table<RecT, KeyT...> &table,
+				const Patch<RecT> &patch):
+    TableChange<RecT, KeyT...>(patch.op, table, patch.rec),
+    prev_rec(patch.prev)
   { }
 
   template <typename RecT, typename...KeyT>
   void Update<RecT, KeyT...>::apply(Ctx &ctx) const {
     auto &tbl(get_table<RecT, KeyT...>(ctx, this->table.name));
-    update_rec(tbl, this->rec, tbl.key(this->prev_rec));
+
+    if (this->op == TABLE_PATCH) {
+      auto rec(patch_rec(tbl, this->rec));
+      if (rec) { update_rec(tbl, *rec, tbl.key(*rec)); }
+    } else {
+      update_rec(tbl, this->rec, tbl.key(this->prev_rec));
+    }
   }
 
   template <typename RecT, typename...KeyT>
   void Update<RecT, KeyT...>::rollback() const {
-    update_rec(this->table, this->prev_rec, this->table.key(this->rec));
+    if (this->op == TABLE_PATCH) {
+      auto rec(patch_rec(this->table, this->prev_rec));
+      if (rec) { update_rec(this->table, *rec, this->table.key(*rec)); }
+    } else {
+      update_rec(this->table, this->prev_rec, this->table.key(this->rec));
+    }
   }
 
   template <typename RecT, typename...KeyT>
   void Update<RecT, KeyT...>::undo() const {
-    update(this->table, this->prev_rec, this->rec);
+    if (this->op == TABLE_PATCH) {
+      auto rec(patch_rec(this->table, this->prev_rec));
+      if (rec) { update(this->table, *rec); }
+    } else {
+      update(this->table, this->prev_rec, this->rec);
+    }
   }
 
   template <typename RecT, typename...KeyT>
-  void Update<RecT, KeyT...>::write(std::ostream &out) const {
+  void Update<RecT, KeyT...>::write(Frame &out) const {
     if (this->table.key(this->rec) == this->table.key(this->prev_rec)) {
       TableChange<RecT, KeyT...>::write(out);
     } else {
-      db::write(this->table, TABLE_ERASE, this->prev_rec, out);
-      db::write(this->table, TABLE_INSERT, this->rec, out);
+      db::write(out, TABLE_ERASE, this->prev_rec);
+      db::write(out, TABLE_INSERT, this->rec);
     }
   }
   
@@ -460,12 +563,12 @@ namespace db {
   template <typename RecT, typename...KeyT>
   void Erase<RecT, KeyT...>::apply(Ctx &ctx) const {
     auto &tbl(get_table<RecT, KeyT...>(ctx, this->table.name));
-    tbl.recs.erase(tbl.key(this->rec));
+    erase_rec(tbl, tbl.key(this->rec));
   }
 
   template <typename RecT, typename...KeyT>
   void Erase<RecT, KeyT...>::rollback() const {
-    this->table.recs.emplace(this->table.key(this->rec), this->rec);
+    insert_rec(this->table, this->table.key(this->rec), this->rec);
   }
 
   template <typename RecT, typename...KeyT>
@@ -0,0 +1,167 @@
+#ifndef SNACKIS_DB_TAG_INDEX_HPP
+#define SNACKIS_DB_TAG_INDEX_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "snackis/core/bitmap.hpp"
+#include "snackis/core/str.hpp"
+#include "snackis/db/col.hpp"
+#include "snackis/db/docs.hpp"
+#include "snackis/db/index.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/query.hpp"
+#include "snackis/db/rec.hpp"
+
+namespace snackis {
+namespace db {
+  template <typename RecT, typename...KeyT>
+  struct TagIndex: Index<RecT> {
+    using Key = db::Key<RecT, KeyT...>;
+    using TagCol = Col<RecT, std::set<str>>;
+
+    const TagCol &col;
+    Docs<RecT, KeyT...> &docs;
+    Bitmap doc_ids;
+    std::map<str, Bitmap> tags;
+
+    TagIndex(Ctx &ctx, const str &name, Docs<RecT, KeyT...> &docs,
+	      const TagCol &col);
+
+    bool insert(const Rec<RecT> &rec) override;
+    bool update(const Rec<RecT> &rec, const Rec<RecT> &prev) override;
+    bool erase(const Rec<RecT> &rec) override;
+
+    void dump(std::ostream &out) override;
+    void slurp() override;
+  };
+
+  template <typename RecT, typename...KeyT>
+  TagIndex<RecT, KeyT...>::TagIndex(Ctx &ctx,
+				    const str &name,
+				    Docs<RecT, KeyT...> &docs,
+				    const TagCol &col):
+    Index<RecT>(ctx, name, {}),
+    col(col),
+    docs(docs)
+  {
+    for_each(docs.key, [this](auto c) { add(*this, *c); });
+  }
+
+  template <typename RecT, typename...KeyT>
+  void add_tags(TagIndex<RecT, KeyT...> &idx,
+		const std::set<str> &tags,
+		int64_t doc) {
+    for (auto &t: tags) { set(idx.tags[t], doc); }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void remove_tags(TagIndex<RecT, KeyT...> &idx,
+		   const std::set<str> &tags,
+		   int64_t doc) {
+    for (auto &t: tags) {
+      auto fnd(idx.tags.find(t));
+      if (fnd == idx.tags.end()) { continue; }
+      clear(fnd->second, doc);
+      if (empty(fnd->second)) { idx.tags.erase(fnd); }
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TagIndex<RecT, KeyT...>::insert(const Rec<RecT> &rec) {
+    auto doc(db::insert(docs, rec, doc_ids));
+    if (!doc) { return false; }
+    add_tags(*this, get_val(rec, col), *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TagIndex<RecT, KeyT...>::update(const Rec<RecT> &rec,
+				       const Rec<RecT> &prev) {
+    auto doc(db::update(docs, rec, prev, doc_ids));
+    if (!doc) { return insert(rec); }
+    const auto prev_tags(get_val(prev, col)), tags(get_val(rec, col));
+    std::set<str> gone, added;
+
+    std::set_difference(prev_tags.begin(), prev_tags.end(),
+			tags.begin(), tags.end(),
+			std::inserter(gone, gone.end()));
+
+    std::set_difference(tags.begin(), tags.end(),
+			prev_tags.begin(), prev_tags.end(),
+			std::inserter(added, added.end()));
+
+    remove_tags(*this, gone, *doc);
+    add_tags(*this, added, *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TagIndex<RecT, KeyT...>::erase(const Rec<RecT> &rec) {
+    auto doc(db::erase(docs, rec, doc_ids));
+    if (!doc) { return false; }
+    remove_tags(*this, get_val(rec, col), *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void TagIndex<RecT, KeyT...>::dump(std::ostream &out) { }
+
+  template <typename RecT, typename...KeyT>
+  void TagIndex<RecT, KeyT...>::slurp() { }
+
+  template <typename RecT, typename...KeyT>
+  Bitmap get_bitmap(const TagIndex<RecT, KeyT...> &idx,
+		    const std::set<str> &tags) {
+    std::vector<const Bitmap *> bms;
+
+    for (auto &t: tags) {
+      auto fnd(idx.tags.find(t));
+      if (fnd == idx.tags.end()) { return Bitmap(); }
+      bms.push_back(&fnd->second);
+    }
+
+    if (bms.empty()) { return Bitmap(); }
+
+    std::sort(bms.begin(), bms.end(), [](auto x, auto y) {
+	return size(*x) < size(*y);
+      });
+
+    Bitmap out(*bms.front());
+
+    for (auto i(std::next(bms.begin())); i != bms.end() && !empty(out); i++) {
+      out = intersect(out, **i);
+    }
+
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::vector<const Rec<RecT> *> find(const TagIndex<RecT, KeyT...> &idx,
+				      const std::set<str> &tags) {
+    return get_recs(idx.docs, get_vals(get_bitmap(idx, tags)));
+  }
+
+  template <typename RecT, typename...KeyT>
+  size_t count(const TagIndex<RecT, KeyT...> &idx, const str &tag) {
+    auto fnd(idx.tags.find(tag));
+    return (fnd == idx.tags.end()) ? 0 : size(fnd->second);
+  }
+
+  template <typename RecT, typename...KeyT>
+  size_t count(const TagIndex<RecT, KeyT...> &idx, const std::set<str> &tags) {
+    return size(get_bitmap(idx, tags));
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::map<str, size_t> get_counts(const TagIndex<RecT, KeyT...> &idx) {
+    std::map<str, size_t> out;
+    for (auto &t: idx.tags) { out.emplace(t.first, size(t.second)); }
+    return out;
+  }
+}}
+
+#endif
@@ -0,0 +1,138 @@
+#include <cctype>
+
+#include "snackis/db/text_index.hpp"
+
+namespace snackis {
+namespace db {
+  PostingsBlock::PostingsBlock():
+    last(-1), size(0)
+  { }
+
+  Postings::Postings():
+    size(0)
+  { }
+
+  static bool is_word(unsigned char c) {
+    return std::isalnum(c) || c >= 0x80;
+  }
+
+  std::set<str> tokenize(const str &in) {
+    std::set<str> out;
+    str tok;
+
+    for (unsigned char c: in) {
+      if (is_word(c)) {
+	tok.push_back(std::tolower(c));
+      } else if (!tok.empty()) {
+	out.insert(tok);
+	tok.clear();
+      }
+    }
+
+    if (!tok.empty()) { out.insert(tok); }
+    return out;
+  }
+
+  static void encode(Data &out, uint64_t delta) {
+    while (delta >= 0x80) {
+      out.push_back((delta & 0x7f) | 0x80);
+      delta >>= 7;
+    }
+
+    out.push_back(delta);
+  }
+
+  static void append(PostingsBlock &b, int64_t doc) {
+    encode(b.data, doc - b.last);
+    b.last = doc;
+    b.size++;
+  }
+
+  static void encode(PostingsBlock &b,
+		     DocIds::const_iterator beg, DocIds::const_iterator end) {
+    b = PostingsBlock();
+    for (; beg != end; beg++) { append(b, *beg); }
+  }
+
+  static void decode(const PostingsBlock &b, DocIds &out) {
+    int64_t prev(-1);
+    uint64_t delta(0);
+    int shift(0);
+
+    for (auto c: b.data) {
+      delta |= uint64_t(c & 0x7f) << shift;
+
+      if (c & 0x80) {
+	shift += 7;
+      } else {
+	prev += delta;
+	out.push_back(prev);
+	delta = 0;
+	shift = 0;
+      }
+    }
+  }
+
+  DocIds decode(const Postings &p) {
+    DocIds out;
+    out.reserve(p.size);
+    for (auto &b: p.blocks) { decode(b, out); }
+    return out;
+  }
+
+  static std::vector<PostingsBlock>::iterator find_block(Postings &p,
+							 int64_t doc) {
+    return std::lower_bound(p.blocks.begin(), p.blocks.end(), doc,
+			    [](const PostingsBlock &b, int64_t doc) {
+			      return b.last < doc;
+			    });
+  }
+  
+  void add(Postings &p, int64_t doc) {
+    if (p.blocks.empty() || doc > p.blocks.back().last) {
+      if (p.blocks.empty() || p.blocks.back().size == POSTINGS_BLOCK) {
+	p.blocks.emplace_back();
+      }
+      
+      append(p.blocks.back(), doc);
+      p.size++;
+      return;
+    }
+
+    auto b(find_block(p, doc));
+    DocIds ids;
+    decode(*b, ids);
+    auto fnd(std::lower_bound(ids.begin(), ids.end(), doc));
+    if (fnd != ids.end() && *fnd == doc) { return; }
+    ids.insert(fnd, doc);
+    p.size++;
+
+    if (int64_t(ids.size()) < 2*POSTINGS_BLOCK) {
+      encode(*b, ids.begin(), ids.end());
+      return;
+    }
+
+    auto mid(ids.begin() + ids.size()/2);
+    encode(*b, ids.begin(), mid);
+    encode(*p.blocks.insert(std::next(b), PostingsBlock()), mid, ids.end());
+  }
+
+  bool remove(Postings &p, int64_t doc) {
+    auto b(find_block(p, doc));
+    if (b == p.blocks.end()) { return !p.size; }
+    DocIds ids;
+    decode(*b, ids);
+    auto fnd(std::lower_bound(ids.begin(), ids.end(), doc));
+    if (fnd == ids.end() || *fnd != doc) { return !p.size; }
+    ids.erase(fnd);
+    p.size--;
+
+    if (ids.empty()) {
+      p.blocks.erase(b);
+    } else {
+      encode(*b, ids.begin(), ids.end());
+    }
+    
+    return !p.size;
+  }
+}}
@@ -0,0 +1,213 @@
+#ifndef SNACKIS_DB_TEXT_INDEX_HPP
+#define SNACKIS_DB_TEXT_INDEX_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "snackis/core/data.hpp"
+#include "snackis/core/str.hpp"
+#include "snackis/db/col.hpp"
+#include "snackis/db/docs.hpp"
+#include "snackis/db/index.hpp"
+#include "snackis/db/key.hpp"
+#include "snackis/db/query.hpp"
+#include "snackis/db/rec.hpp"
+
+namespace snackis {
+namespace db {
+  // Postings are split into blocks so recycled and updated doc ids only
+  // re-encode the block they land in.
+  const int64_t POSTINGS_BLOCK(128);
+
+  struct PostingsBlock {
+    Data data;
+    int64_t last, size;
+
+    PostingsBlock();
+  };
+  
+  struct Postings {
+    std::vector<PostingsBlock> blocks;
+    int64_t size;
+
+    Postings();
+  };
+
+  using DocIds = std::vector<int64_t>;
+
+  std::set<str> tokenize(const str &in);
+
+  void add(Postings &p, int64_t doc);
+  bool remove(Postings &p, int64_t doc);
+  DocIds decode(const Postings &p);
+
+  template <typename RecT, typename...KeyT>
+  struct TextIndex: Index<RecT> {
+    using Key = db::Key<RecT, KeyT...>;
+    using TextCols = std::initializer_list<const Col<RecT, str> *>;
+
+    const std::vector<const Col<RecT, str> *> text_cols;
+    Docs<RecT, KeyT...> &docs;
+    Bitmap doc_ids;
+    std::map<str, Postings> terms;
+
+    TextIndex(Ctx &ctx, const str &name, Docs<RecT, KeyT...> &docs,
+	      TextCols text_cols);
+
+    bool insert(const Rec<RecT> &rec) override;
+    bool update(const Rec<RecT> &rec, const Rec<RecT> &prev) override;
+    bool erase(const Rec<RecT> &rec) override;
+
+    void dump(std::ostream &out) override;
+    void slurp() override;
+  };
+
+  template <typename RecT, typename...KeyT>
+  TextIndex<RecT, KeyT...>::TextIndex(Ctx &ctx,
+				      const str &name,
+				      Docs<RecT, KeyT...> &docs,
+				      TextCols text_cols):
+    Index<RecT>(ctx, name, {}),
+    text_cols(text_cols),
+    docs(docs)
+  {
+    for_each(docs.key, [this](auto c) { add(*this, *c); });
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::set<str> get_terms(const TextIndex<RecT, KeyT...> &idx,
+			  const Rec<RecT> &rec) {
+    std::set<str> out;
+
+    for (auto c: idx.text_cols) {
+      auto ts(tokenize(get_val(rec, *c)));
+      out.insert(ts.begin(), ts.end());
+    }
+
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void add_terms(TextIndex<RecT, KeyT...> &idx,
+		 const std::set<str> &terms,
+		 int64_t doc) {
+    for (auto &t: terms) { add(idx.terms[t], doc); }
+  }
+
+  template <typename RecT, typename...KeyT>
+  void remove_terms(TextIndex<RecT, KeyT...> &idx,
+		    const std::set<str> &terms,
+		    int64_t doc) {
+    for (auto &t: terms) {
+      auto fnd(idx.terms.find(t));
+      if (fnd != idx.terms.end() && remove(fnd->second, doc)) {
+	idx.terms.erase(fnd);
+      }
+    }
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TextIndex<RecT, KeyT...>::insert(const Rec<RecT> &rec) {
+    auto doc(db::insert(docs, rec, doc_ids));
+    if (!doc) { return false; }
+    add_terms(*this, get_terms(*this, rec), *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TextIndex<RecT, KeyT...>::update(const Rec<RecT> &rec,
+					const Rec<RecT> &prev) {
+    auto doc(db::update(docs, rec, prev, doc_ids));
+    if (!doc) { return insert(rec); }
+    const auto prev_terms(get_terms(*this, prev)), terms(get_terms(*this, rec));
+    std::set<str> gone, added;
+
+    std::set_difference(prev_terms.begin(), prev_terms.end(),
+			terms.begin(), terms.end(),
+			std::inserter(gone, gone.end()));
+
+    std::set_difference(terms.begin(), terms.end(),
+			prev_terms.begin(), prev_terms.end(),
+			std::inserter(added, added.end()));
+
+    remove_terms(*this, gone, *doc);
+    add_terms(*this, added, *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  bool TextIndex<RecT, KeyT...>::erase(const Rec<RecT> &rec) {
+    auto doc(db::erase(docs, rec, doc_ids));
+    if (!doc) { return false; }
+    remove_terms(*this, get_terms(*this, rec), *doc);
+    return true;
+  }
+
+  template <typename RecT, typename...KeyT>
+  void TextIndex<RecT, KeyT...>::dump(std::ostream &out) { }
+
+  template <typename RecT, typename...KeyT>
+  void TextIndex<RecT, KeyT...>::slurp() { }
+
+  template <typename RecT, typename...KeyT>
+  DocIds find_prefix(const TextIndex<RecT, KeyT...> &idx, const str &prefix) {
+    DocIds out;
+
+    for (auto i(idx.terms.lower_bound(prefix));
+	 i != idx.terms.end() && i->first.compare(0, prefix.size(), prefix) == 0;
+	 i++) {
+      auto ids(decode(i->second));
+      out.insert(out.end(), ids.begin(), ids.end());
+    }
+
+    // Merge once, short prefixes may match thousands of terms
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+  }
+
+  template <typename RecT, typename...KeyT, typename FindT>
+  std::vector<const Rec<RecT> *> search_all(const TextIndex<RecT, KeyT...> &idx,
+					    const std::set<str> &terms,
+					    FindT find) {
+    DocIds out;
+    bool first(true);
+
+    for (auto &t: terms) {
+      auto ids(find(t));
+
+      if (first) {
+	out = std::move(ids);
+	first = false;
+      } else {
+	DocIds prev(std::move(out));
+	out.clear();
+	std::set_intersection(prev.begin(), prev.end(), ids.begin(), ids.end(),
+			      std::back_inserter(out));
+      }
+
+      if (out.empty()) { break; }
+    }
+
+    return get_recs(idx.docs, out);
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::vector<const Rec<RecT> *> search(const TextIndex<RecT, KeyT...> &idx,
+					const std::set<str> &terms) {
+    return search_all(idx, terms, [&idx](auto &t) {
+	return find_prefix(idx, t);
+      });
+  }
+
+  template <typename RecT, typename...KeyT>
+  std::vector<const Rec<RecT> *> search(const TextIndex<RecT, KeyT...> &idx,
+					const str &query) {
+    return search(idx, tokenize(query));
+  }
+}}
+
+#endif
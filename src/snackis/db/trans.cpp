@@ -1,3 +1,4 @@
+#include "snackis/core/time.hpp"
 #include "snackis/db/change.hpp"
 #include "snackis/db/ctx.hpp"
 #include "snackis/db/trans.hpp"
@@ -31,6 +32,7 @@ namespace db {
     Msg msg(MSG_COMMIT);
     set(msg, Msg::SENDER, &ctx);
     set(msg, Msg::CHANGES, trans.changes);
+    set(msg, Msg::QUEUED, int64_t(usecs(pnow().time_since_epoch())));
     put(ctx.proc.inbox, msg);
     
     if (lbl) {
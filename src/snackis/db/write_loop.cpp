@@ -1,19 +1,45 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
 #include "snackis/db/basic_table.hpp"
+#include "snackis/db/checkpoint.hpp"
 #include "snackis/db/ctx.hpp"
 #include "snackis/db/error.hpp"
+#include "snackis/db/frame.hpp"
 #include "snackis/db/proc.hpp"
 #include "snackis/db/write_loop.hpp"
 
 namespace snackis {
 namespace db {
+  Segment::Segment():
+    recs(0), dead(0), tail(0), gen(0)
+  { }
+  
   WriteLoop::WriteLoop(Proc &p, size_t max_buf):
-    Loop(p, max_buf)
+    Loop(p, max_buf),
+    compact_ratio(0.5),
+    compact_min(1000),
+    checkpoint_min(10000),
+    sync_mode(SYNC_FLUSH),
+    sync_msecs(0),
+    synced_at(pnow()),
+    compactions(0),
+    compact_reclaimed(0),
+    checkpoints(0),
+    compact_pool(1, max_buf)
   {
     start(*this);
   }
 
+  static void sync_files(WriteLoop &lp, const std::set<Path> &paths);
+
   WriteLoop::~WriteLoop() {
     stop(*this);
+    if (sync_mode.load() == SYNC_INTERVAL) { sync_files(*this, unsynced); }
+    for (auto &fd: fds) { ::close(fd.second); }
   }
   
   static std::ofstream &get_file(WriteLoop &lp, const Path &p) {
@@ -36,36 +62,360 @@ namespace db {
     return fnd->second;
   }
 
-  void WriteLoop::on_msg(const Msg &msg) {
-    auto ctx(get(msg, Msg::SENDER));
+  static int get_fd(WriteLoop &lp, const Path &p) {
+    auto fnd(lp.fds.find(p));
+    if (fnd != lp.fds.end()) { return fnd->second; }
+    int fd(::open(p.string().c_str(), O_WRONLY | O_APPEND));
 
-    switch (msg.type) {
-    case MSG_COMMIT: { 
-      std::set<std::ofstream *> dirty;
+    if (fd == -1) {
+      ERROR(Db, fmt("Failed opening file for sync: %0", p.string()));
+      return -1;
+    }
+
+    lp.fds.emplace(p, fd);
+    return fd;
+  }
+
+  static void sync_files(WriteLoop &lp, const std::set<Path> &paths) {
+    for (auto &p: paths) {
+      auto fd(get_fd(lp, p));
+      
+      if (fd != -1 && fdatasync(fd) == -1) {
+	ERROR(Db, fmt("Failed syncing file: %0", p.string()));
+      }
+    }
+  }
+  
+  static int64_t sync_left(const WriteLoop &lp, const PTime &start) {
+    return lp.sync_msecs.load()*1000 - usecs(start-lp.synced_at);
+  }
+  
+  static void sync_due(WriteLoop &lp) {
+    auto start(pnow());
+    if (lp.unsynced.empty() || sync_left(lp, start) > 0) { return; }
+    sync_files(lp, lp.unsynced);
+    lp.unsynced.clear();
+    lp.synced_at = start;
+  }
+  
+  static void sync(WriteLoop &lp, const std::set<Path> &dirty) {
+    auto mode(lp.sync_mode.load());
+    if (mode == SYNC_NONE) { return; }
+    for (auto &p: dirty) { get_file(lp, p).flush(); }
+    
+    switch (mode) {
+    case SYNC_BATCH:
+      sync_files(lp, dirty);
+      break;
+    case SYNC_INTERVAL:
+      lp.unsynced.insert(dirty.begin(), dirty.end());
+      sync_due(lp);
+      break;
+    default:
+      break;
+    }
+  }
+
+  static int64_t get_size(const Path &p) {
+    std::error_code err;
+    auto size(stdfs::file_size(p, err));
+    return err ? 0 : size;
+  }
+
+  static Path tmp_path(const Path &p, int64_t gen) {
+    return p.string() + fmt(".%0.new", gen);
+  }
+
+  static Path checkpoint_tmp(const Path &p, int64_t gen) {
+    return checkpoint_path(p).string() + fmt(".%0.new", gen);
+  }
+
+  static void sync_tmp(WriteLoop &lp, const Path &tmp) {
+    if (lp.sync_mode.load() == SYNC_NONE) { return; }
+    int fd(::open(tmp.string().c_str(), O_WRONLY));
+      
+    if (fd == -1 || fdatasync(fd) == -1) {
+      ERROR(Db, fmt("Failed syncing file: %0", tmp.string()));
+    }
+    
+    if (fd != -1) { ::close(fd); }
+  }
+  
+  static int64_t swap_file(WriteLoop &lp, const Path &p, const Path &tmp) {
+    sync_tmp(lp, tmp);
+    remove_path(checkpoint_path(p));
+    const int64_t reclaimed(get_size(p)-get_size(tmp));
+    lp.files.erase(p);
+    auto fd(lp.fds.find(p));
+    
+    if (fd != lp.fds.end()) {
+      ::close(fd->second);
+      lp.fds.erase(fd);
+    }
+
+    lp.unsynced.erase(p);
+    std::error_code err;
+    stdfs::rename(tmp, p, err);
+    
+    if (err) {
+      ERROR(Db, fmt("Failed replacing file: %0", p.string()));
+      return 0;
+    }
+
+    return reclaimed;
+  }
+  
+  static void compact(WriteLoop &lp, const Path &p) {
+    auto &seg(lp.segments[p]);
+    if (!seg.compactor || seg.compact_end || !path_exists(p)) { return; }
+    get_file(lp, p).flush();
+    const int64_t end(get_size(p));
+    const Path tmp(tmp_path(p, seg.gen));
+    const Compactor cmp(*seg.compactor);
+    const int64_t gen(seg.gen);
+    
+    auto ok(post(lp.compact_pool, [&lp, p, tmp, end, gen, cmp]() {
+	  TRY(try_compact);
+	  std::ifstream in(p.string(), std::ios::in | std::ios::binary);
+	  std::ofstream out(tmp.string(),
+			    std::ios::out | std::ios::binary | std::ios::trunc);
+	  int64_t live(-1);
+	  
+	  if (in.fail() || out.fail()) {
+	    ERROR(Db, fmt("Failed compacting file: %0", p.string()));
+	  } else {
+	    live = cmp({Span {&in, end}}, out);
+	  }
+
+	  out.close();
+	  if (!try_compact.errors.empty()) { live = -1; }
+	  Msg msg(MSG_COMPACTED);
+	  set(msg, Msg::PATH, p.string());
+	  set(msg, Msg::GEN, gen);
+	  set(msg, Msg::RECS, live);
+	  if (!put(lp.inbox, msg)) { remove_path(tmp); }
+	}, false));
+
+    if (ok) {
+      seg.compact_end = end;
+      seg.recs = seg.dead = 0;
+    }
+  }
+
+  static void compacted(WriteLoop &lp, const Msg &msg) {
+    const Path p(get(msg, Msg::PATH));
+    const int64_t gen(get(msg, Msg::GEN)), live(get(msg, Msg::RECS));
+    const Path tmp(tmp_path(p, gen));
+    auto &seg(lp.segments[p]);
+    
+    if (gen != seg.gen || !seg.compact_end || live < 0) {
+      remove_path(tmp);
+      if (gen == seg.gen) { seg.compact_end.reset(); }
+      return;
+    }
+
+    get_file(lp, p).flush();
+    std::ifstream in(p.string(), std::ios::in | std::ios::binary);
+    std::ofstream out(tmp.string(),
+		      std::ios::out | std::ios::binary | std::ios::app);
+    in.seekg(*seg.compact_end);
+    seg.compact_end.reset();
+    char buf[64*1024];
+    
+    while (in.read(buf, sizeof buf) || in.gcount()) {
+      out.write(buf, in.gcount());
+    }
+
+    in.close();
+    out.close();
+    
+    if (out.fail()) {
+      remove_path(tmp);
+      ERROR(Db, fmt("Failed compacting file: %0", p.string()));
+      return;
+    }
+    
+    const int64_t reclaimed(swap_file(lp, p, tmp));
+    seg.recs += live;
+    seg.tail = 0;
+    seg.gen++;
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    lp.compactions++;
+    lp.compact_reclaimed += reclaimed;
+  }
+
+  static void checkpoint(WriteLoop &lp, const Path &p) {
+    auto &seg(lp.segments[p]);
+
+    if (!seg.compactor || seg.compact_end || seg.checkpoint_end ||
+	!path_exists(p)) {
+      return;
+    }
+    
+    get_file(lp, p).flush();
+    const int64_t end(get_size(p));
+    const Path chk(checkpoint_path(p)), tmp(checkpoint_tmp(p, seg.gen));
+    const Compactor cmp(*seg.compactor);
+    const int64_t gen(seg.gen);
+    
+    auto ok(post(lp.compact_pool, [&lp, p, chk, tmp, end, gen, cmp]() {
+	  TRY(try_checkpoint);
+	  std::ifstream prev(chk.string(), std::ios::in | std::ios::binary);
+	  std::ifstream in(p.string(), std::ios::in | std::ios::binary);
+	  std::ofstream out(tmp.string(),
+			    std::ios::out | std::ios::binary | std::ios::trunc);
+	  int64_t live(-1);
+	  
+	  if (in.fail() || out.fail()) {
+	    ERROR(Db, fmt("Failed checkpointing file: %0", p.string()));
+	  } else {
+	    std::vector<Span> spans;
+	    auto start(prev.fail() ? nullopt : read_checkpoint(prev, p));
+	    
+	    if (start) {
+	      spans.push_back(Span {&prev, get_size(chk)});
+	      in.seekg(*start);
+	    }
+	    
+	    spans.push_back(Span {&in, end});
+	    write_checkpoint(out, end);
+	    live = cmp(spans, out);
+	  }
+
+	  out.close();
+	  if (out.fail() || !try_checkpoint.errors.empty()) { live = -1; }
+	  Msg msg(MSG_CHECKPOINTED);
+	  set(msg, Msg::PATH, p.string());
+	  set(msg, Msg::GEN, gen);
+	  set(msg, Msg::RECS, live);
+	  if (!put(lp.inbox, msg)) { remove_path(tmp); }
+	}, false));
+
+    if (ok) {
+      seg.checkpoint_end = end;
+      seg.tail = 0;
+    }
+  }
 
+  static void checkpointed(WriteLoop &lp, const Msg &msg) {
+    const Path p(get(msg, Msg::PATH));
+    const int64_t gen(get(msg, Msg::GEN)), live(get(msg, Msg::RECS));
+    const Path tmp(checkpoint_tmp(p, gen));
+    auto &seg(lp.segments[p]);
+    if (gen == seg.gen) { seg.checkpoint_end.reset(); }
+    
+    if (gen != seg.gen || live < 0) {
+      remove_path(tmp);
+      return;
+    }
+
+    sync_tmp(lp, tmp);
+    std::error_code err;
+    stdfs::rename(tmp, checkpoint_path(p), err);
+    
+    if (err) {
+      remove_path(tmp);
+      ERROR(Db, fmt("Failed replacing file: %0", p.string()));
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    lp.checkpoints++;
+  }
+
+  static bool compact_due(const WriteLoop &lp, const Segment &seg) {
+    return
+      seg.dead >= lp.compact_min &&
+      seg.dead >= seg.recs * lp.compact_ratio;
+  }
+
+  static bool checkpoint_due(const WriteLoop &lp, const Segment &seg) {
+    return seg.tail >= lp.checkpoint_min;
+  }
+  
+  static void commit(WriteLoop &lp, const std::vector<Msg> &batch) {
+    std::set<Path> dirty;
+    
+    for (auto &msg: batch) {
+      const opt<crypt::Secret> sec(get(msg, Msg::SENDER)->secret);
+      std::map<Path, Frame> frames;
+      
       for (auto &c: get(msg, Msg::CHANGES)) {
-	auto &f(get_file(*this, c->table_path()));
+	auto p(c->table_path());
+	auto &f(get_file(lp, p));
 
 	if (!f.fail()) {
-	  c->write(f);
-	  dirty.insert(&f);
+	  auto fr(frames.find(p));
+
+	  if (fr == frames.end()) {
+	    fr = frames.emplace(std::piecewise_construct,
+				std::forward_as_tuple(p),
+				std::forward_as_tuple(f, sec, lp.nonce, 0)).first;
+	  }
+	  
+	  c->write(fr->second);
+	  dirty.insert(p);
+	  auto &seg(lp.segments[p]);
+	  if (!seg.compactor) { seg.compactor = c->compactor(); }
+	  seg.recs++;
+	  seg.tail++;
+	  seg.dead += c->dead_recs();
 	}
       }
 
-      for (auto f: dirty) { f->flush(); }
-      break;
+      for (auto &fr: frames) { seal(fr.second); }
     }
+
+    sync(lp, dirty);
+
+    for (auto &p: dirty) {
+      auto &seg(lp.segments[p]);
+      
+      if (compact_due(lp, seg)) {
+	compact(lp, p);
+      } else if (checkpoint_due(lp, seg)) {
+	checkpoint(lp, p);
+      }
+    }
+    
+    const int64_t end(usecs(pnow().time_since_epoch()));
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    add(lp.batch_size, batch.size());
+    
+    for (auto &msg: batch) {
+      auto queued(find(msg, Msg::QUEUED));
+      if (queued) { add(lp.commit_usecs, end-*queued); }
+    }
+  }
+  
+  void WriteLoop::on_msg(const Msg &msg) {
+    switch (msg.type) {
+    case MSG_COMMIT:
+      commit(*this, {msg});
+      break;
     case MSG_REWRITE: {
+      auto ctx(get(msg, Msg::SENDER));
       int64_t reclaimed(0); 
       
       for (auto t: ctx->tables) {
-	auto &f(get_file(*this, t.second->path));
-	auto old_size(f.tellp());
-	f.close();
-	f.open(t.second->path.string(), 
-	       std::ios::out | std::ios::binary | std::ios::trunc);
+	auto &p(t.second->path);
+	auto &seg(segments[p]);
+	const int64_t gen(seg.gen+1);
+	seg = Segment();
+	seg.gen = gen;
+	const Path tmp(tmp_path(p, gen));
+	std::ofstream f(tmp.string(),
+			std::ios::out | std::ios::binary | std::ios::trunc);
 	t.second->dump(f);
-	reclaimed += old_size-f.tellp();
+	f.close();
+
+	if (f.fail()) {
+	  remove_path(tmp);
+	  ERROR(Db, fmt("Failed rewriting file: %0", p.string()));
+	  continue;
+	}
+	
+	reclaimed += swap_file(*this, p, tmp);
       }
 
       Msg msg(MSG_OK);
@@ -73,8 +423,89 @@ namespace db {
       put(ctx->inbox, msg);
       break;
     }
+    case MSG_COMPACT: {
+      auto ctx(get(msg, Msg::SENDER));
+
+      for (auto t: ctx->tables) {
+	auto &seg(segments[t.second->path]);
+	if (!seg.compactor) { seg.compactor = t.second->compactor(); }
+	compact(*this, t.second->path);
+      }
+
+      put(ctx->inbox, Msg(MSG_OK));
+      break;
+    }
+    case MSG_SYNC: {
+      auto ctx(get(msg, Msg::SENDER));
+      std::set<Path> paths;
+
+      for (auto &f: files) {
+	f.second.flush();
+	paths.insert(f.first);
+      }
+
+      sync_files(*this, paths);
+      unsynced.clear();
+      synced_at = pnow();
+      put(ctx->inbox, Msg(MSG_OK));
+      break;
+    }
+    case MSG_COMPACTED:
+      compacted(*this, msg);
+      break;
+    case MSG_CHECKPOINTED:
+      checkpointed(*this, msg);
+      break;
     default:
       log(proc, "Unsupported message type: %0", msg.type);
     }
   }
+
+  void WriteLoop::on_batch(const std::vector<Msg> &msgs) {
+    std::vector<Msg> batch;
+    
+    for (auto &msg: msgs) {
+      if (msg.type == MSG_COMMIT) {
+	batch.push_back(msg);
+	continue;
+      }
+
+      if (!batch.empty()) {
+	commit(*this, batch);
+	batch.clear();
+      }
+      
+      on_msg(msg);
+    }
+
+    if (!batch.empty()) { commit(*this, batch); }
+  }
+
+  opt<int64_t> WriteLoop::idle_usecs() {
+    if (sync_mode.load() != SYNC_INTERVAL || unsynced.empty()) {
+      return nullopt;
+    }
+    
+    return std::max(sync_left(*this, pnow()), int64_t(0));
+  }
+
+  void WriteLoop::on_idle() {
+    if (sync_mode.load() == SYNC_INTERVAL) { sync_due(*this); }
+  }
+
+  void set_sync(WriteLoop &lp, SyncMode mode, int64_t msecs) {
+    lp.sync_msecs.store(msecs);
+    lp.sync_mode.store(mode);
+  }
+
+  str fmt_stats(WriteLoop &lp) {
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    return fmt("Commit latency (us): %0\n"
+	       "Commit batch size: %1\n"
+	       "Compactions: %2, %3k reclaimed\n"
+	       "Checkpoints: %4",
+	       lp.commit_usecs, lp.batch_size,
+	       lp.compactions, lp.compact_reclaimed / 1000,
+	       lp.checkpoints);
+  }
 }}
@@ -1,23 +1,61 @@
 #ifndef SNACKIS_DB_WRITE_LOOP_HPP
 #define SNACKIS_DB_WRITE_LOOP_HPP
 
+#include <atomic>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <set>
 
+#include "snackis/core/hist.hpp"
+#include "snackis/core/opt.hpp"
 #include "snackis/core/path.hpp"
+#include "snackis/core/pool.hpp"
+#include "snackis/core/time.hpp"
+#include "snackis/crypt/secret.hpp"
+#include "snackis/db/basic_table.hpp"
 #include "snackis/db/loop.hpp"
 
 namespace snackis {
 namespace db {
   struct Proc;
+
+  enum SyncMode { SYNC_NONE, SYNC_FLUSH, SYNC_BATCH, SYNC_INTERVAL };
+
+  struct Segment {
+    int64_t recs, dead, tail, gen;
+    opt<Compactor> compactor;
+    opt<int64_t> compact_end, checkpoint_end;
+
+    Segment();
+  };
   
   struct WriteLoop: Loop {
     std::map<Path, std::ofstream> files;
-    
+    std::map<Path, Segment> segments;
+    double compact_ratio;
+    int64_t compact_min, checkpoint_min;
+    std::map<Path, int> fds;
+    std::atomic<SyncMode> sync_mode;
+    std::atomic<int64_t> sync_msecs;
+    std::set<Path> unsynced;
+    PTime synced_at;
+    std::mutex stats_mutex;
+    Hist commit_usecs, batch_size;
+    int64_t compactions, compact_reclaimed, checkpoints;
+    Pool compact_pool;
+    crypt::Nonce nonce;
+
     WriteLoop(Proc &p, size_t max_buf);
     ~WriteLoop();
     void on_msg(const Msg &msg) override;
+    void on_batch(const std::vector<Msg> &msgs) override;
+    opt<int64_t> idle_usecs() override;
+    void on_idle() override;
   };
+
+  void set_sync(WriteLoop &lp, SyncMode mode, int64_t msecs=0);
+  str fmt_stats(WriteLoop &lp);
 }}
 
 #endif
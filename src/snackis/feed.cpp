@@ -69,20 +69,14 @@ namespace snackis {
 						const Time &end,
 						size_t max) {
     Ctx &ctx(fd.ctx);
-    auto &tbl(ctx.db.feed_posts);
+    auto &idx(ctx.db.feed_posts);
     std::vector<const db::Rec<Post> *> out;
-    if (tbl.recs.empty()) { return out; }
+    auto beg(db::lower_bound(idx, std::make_tuple(fd.id)));
+    auto fnd(db::lower_bound(idx, idx.key(fd.id, end, null_uid)));
     
-    auto fnd(tbl.recs.lower_bound(tbl.key(fd.id, end, null_uid)));
-    if (fnd == tbl.recs.begin()) { return out; }
-    fnd--;
-    
-    while (out.size() < max) {
-      if (*db::get(fnd->second, post_feed_id) != fd.id) { break; }
-      const db::Rec<Post> &rec(db::get(ctx.db.posts, fnd->second));
-      out.push_back(&rec);
-      if (fnd == tbl.recs.begin()) { break; }
+    while (fnd != beg && out.size() < max) {
       fnd--;
+      out.push_back(fnd->second);
     }
 
     return out;
@@ -19,11 +19,21 @@ namespace gui {
     push_view(new PostView(ps));
   }
   
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Post> &rec) {
+    Post ps(ctx, rec);
+    Peer pr(get_peer_id(ctx, ps.owner_id));
+    
+    return {fmt("%0\n%1",
+		pr.name.c_str(),
+		fmt(ps.created_at, "%a %b %d, %H:%M").c_str()),
+	    ps.body};
+  }
+  
   FeedHistory::FeedHistory(Ctx &ctx):
     ctx(ctx),
-    store(gtk_tree_store_new(3, G_TYPE_POINTER,
-			     G_TYPE_STRING,
-			     G_TYPE_STRING)),
+    store(new_rec_model<Post>(2, [&ctx](auto &rec) {
+	  return fmt_row(ctx, rec);
+	})),
     box(gtk_box_new(GTK_ORIENTATION_VERTICAL, 5)),
     lst(new_tree_view(GTK_TREE_MODEL(store)))
   {
@@ -42,34 +52,22 @@ namespace gui {
   GtkWidget *FeedHistory::ptr() { return box; }
 
   void clear(FeedHistory &w) {
-    gtk_tree_store_clear(w.store);
+    clear(w.store);
   }
 
   static void add_post(FeedHistory &w,
 		       const Feed &fd,
 		       const db::Rec<Post> *rec,
 		       Time start,
-		       GtkTreeIter *parent) {
-    Post ps(w.ctx, *rec);
-    Peer pr(get_peer_id(w.ctx, ps.owner_id));
-    
-    GtkTreeIter it;
-    gtk_tree_store_append(w.store, &it, parent);
-    const str by(fmt("%0\n%1",
-		     pr.name.c_str(),
-		     fmt(ps.created_at, "%a %b %d, %H:%M").c_str()));
-    
-    gtk_tree_store_set(w.store, &it,
-		       COL_PTR, rec,
-		       COL_BY, by.c_str(),
-		       COL_BODY, ps.body.c_str(),
-		       -1);
+		       RecRow *parent) {
+    auto row(append(w.store, w.ctx.db.posts, *rec, parent));
+    const UId id(db::get_val(*rec, post_id));
 
-    if (ps.id != fd.id) {
-      auto ps_fd(find_feed_id(w.ctx, ps.id));
+    if (id != fd.id) {
+      auto ps_fd(find_feed_id(w.ctx, id));
       if (ps_fd) {
 	for (auto r: last_posts(*ps_fd, start, FEED_HISTORY_MAX)) {
-	  add_post(w, *ps_fd, r, start, &it);
+	  add_post(w, *ps_fd, r, start, row);
 	}
       }
     }
@@ -85,6 +83,6 @@ namespace gui {
   }
 
   size_t post_count(FeedHistory &w) {
-    return gtk_tree_model_iter_n_children(GTK_TREE_MODEL(w.store), nullptr);
+    return size(w.store);
   }
 }}
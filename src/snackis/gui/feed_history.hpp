@@ -3,6 +3,7 @@
 
 #include "snackis/core/time.hpp"
 #include "snackis/core/uid.hpp"
+#include "snackis/gui/rec_model.hpp"
 #include "snackis/gui/widget.hpp"
 
 namespace snackis {
@@ -14,7 +15,7 @@ namespace gui {
   
   struct FeedHistory: Widget {
     Ctx &ctx;
-    GtkTreeStore *store;
+    RecModel *store;
     GtkWidget *box, *lst;
     
     FeedHistory(Ctx &ctx);
@@ -13,17 +13,24 @@ namespace gui {
     Feed feed(ctx, rec);
     push_view(new FeedView(feed));
   }
+
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Feed> &rec) {
+    Feed feed(ctx, rec);
+    Peer own(get_peer_id(ctx, feed.owner_id));
+    
+    return {id_str(feed),
+	    fmt(feed.created_at, "%a %b %d, %H:%M"),
+	    own.name,
+	    join(feed.tags.begin(), feed.tags.end(), '\n'),
+	    trim(fmt("%0\n%1", feed.name, feed.info))};
+  }
   
   FeedSearch::FeedSearch(Ctx &ctx):
     SearchView<Feed>(ctx,
 		     "Feed",
-		     gtk_list_store_new(6,
-					G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Feed>(5, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     active_fld(gtk_check_button_new_with_label("Active")),
@@ -72,8 +79,6 @@ namespace gui {
   }
 
   void FeedSearch::find() {
-    size_t cnt(0);
-    
     str id_sel(trim(gtk_entry_get_text(GTK_ENTRY(id_fld))));
     bool active_sel(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(active_fld)));
     str tags_str(trim(gtk_entry_get_text(GTK_ENTRY(tags_fld))));
@@ -81,56 +86,30 @@ namespace gui {
     str text_sel(trim(gtk_entry_get_text(GTK_ENTRY(text_fld))));
     auto &peer_sel(peer_fld.selected);
     
-    for (auto key = ctx.db.feeds_sort.recs.rbegin();
-	 key != ctx.db.feeds_sort.recs.rend();
-	 key++) {
-      auto &rec(db::get(ctx.db.feeds, key->second));
-      Feed feed(ctx, rec);
-
-      if (id_sel.empty() && !feed.visible) { continue; }
-
-      if (!id_sel.empty() && find_ci(id_str(feed), id_sel) == str::npos) {
-	continue;
-      }
-
-      if (feed.active != active_sel) { continue; }
-
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    feed.tags.begin(), feed.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!text_sel.empty() &&
-	  find_ci(feed.name, text_sel) == str::npos &&
-	  find_ci(feed.info, text_sel) == str::npos) {
-	continue;
-      }
-
-      if (peer_sel) {
-	if (feed.owner_id != peer_sel->id &&
-	    feed.peer_ids.find(peer_sel->id) == feed.peer_ids.end()) { continue; }
-      }      
-      
-      Peer own(get_peer_id(ctx, feed.owner_id));
+    db::Query<Feed> q(true);
+    
+    if (id_sel.empty()) {
+      add(q, db::Pred<Feed>([](auto &rec) {
+	    auto v(db::get(rec, feed_visible));
+	    return !v || *v;
+	  }));
+    } else {
+      add(q, id_like(feed_id, id_sel));
+    }
 
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(feed).c_str(),
-			 COL_CREATED,
-			 fmt(feed.created_at, "%a %b %d, %H:%M").c_str(),
-			 COL_OWNER, own.name.c_str(),
-			 COL_TAGS,
-			 join(feed.tags.begin(), feed.tags.end(), '\n').c_str(),
-			 COL_INFO, trim(fmt("%0\n%1", feed.name, feed.info)).c_str(),
-			 -1);
-      cnt++;
+    add(q, db::eq(feed_active, active_sel));
+    if (!tags_sel.empty()) { narrow(q, db::find(ctx.db.feeds_tags, tags_sel)); }
+    
+    if (!text_sel.empty()) {
+      add(q, db::any({db::contains_ci(feed_name, text_sel),
+		      db::contains_ci(feed_info, text_sel)}));
     }
 
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    if (peer_sel) {
+      add(q, db::any({db::eq(feed_owner_id, peer_sel->id),
+		      db::has(feed_peer_ids, peer_sel->id)}));
+    }
+    
+    search(*this, ctx.db.feeds, ctx.db.feeds_sort, q);
   }
 }}
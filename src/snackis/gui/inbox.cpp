@@ -31,7 +31,7 @@ namespace gui {
 	
 	if (try_dismiss.errors.empty()) {
 	  db::commit(trans, nullopt);
-	  gtk_list_store_remove(v->store, &it);
+	  remove(v->store, it);
 	}
       });
   }
@@ -74,18 +74,52 @@ namespace gui {
 	}
 
 	if (try_activate.errors.empty()) {
-	  gtk_list_store_remove(v->store, &it);
+	  remove(v->store, it);
 	  db::erase(ctx.db.inbox, msg);
 	  db::commit(trans, nullopt);
 	}
       });
   }
 
+  static str fmt_info(Ctx &ctx, const Msg &msg) {
+    if (msg.type == Msg::INVITE) { return "Invite"; }
+    if (msg.type == Msg::ACCEPT) { return "Invite accepted"; }
+    
+    if (msg.type == Msg::SCRIPT) {
+      Script sct(ctx, msg.script);
+      return fmt("New script:\n%0", sct.name);
+    }
+    
+    if (msg.type == Msg::POST) {
+      Post ps(ctx, msg.post);
+      Feed fd(get_feed_id(ctx, ps.feed_id));
+      return fmt("New post in feed '%0':\n%1", fd.name, ps.body);
+    }
+    
+    if (msg.type == Msg::TASK) {
+      Task tsk(ctx, msg.task);
+      Project prj(get_project_id(ctx, tsk.project_id));
+      return fmt("New task in project '%0':\n%1", prj.name, tsk.name);
+    }
+
+    return fmt("Invalid message type: %0", msg.type);
+  }
+
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Msg> &rec) {
+    Msg msg(ctx, rec);
+    opt<Peer> peer(find_peer_id(ctx, msg.from_id));
+    
+    return {fmt("%0\n%1",
+		peer ? peer->name.c_str() : msg.peer_name.c_str(),
+		msg.from.c_str()),
+	    fmt_info(ctx, msg)};
+  }
+
   Inbox::Inbox(Ctx &ctx):
     View(ctx, "Inbox"),
-    store(gtk_list_store_new(3,
-			     G_TYPE_POINTER,
-			     G_TYPE_STRING, G_TYPE_STRING)),
+    store(new_rec_model<Msg>(2, [&ctx](auto &rec) {
+	  return fmt_row(ctx, rec);
+	})),
     lst(new_tree_view(GTK_TREE_MODEL(store))),
     dismiss_btn(gtk_button_new_with_mnemonic("_Dismiss Selected")),
     cancel_btn(gtk_button_new_with_mnemonic("_Cancel"))
@@ -115,62 +149,13 @@ namespace gui {
 
   void Inbox::load() {
     View::load();
-    gtk_list_store_clear(store);
-    size_t cnt(0);
-    
-    for(const auto &key: ctx.db.inbox_sort.recs) {
-      auto &rec(db::get(ctx.db.inbox, key.second));
-      Msg msg(ctx, rec);
-
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-
-      opt<Peer> peer(find_peer_id(ctx, msg.from_id));
-      const str from(fmt("%0\n%1",
-			 peer ? peer->name.c_str() : msg.peer_name.c_str(),
-			 msg.from.c_str()));
-		    
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_FROM, from.c_str(),
-			 -1);
-      
-      if (msg.type == Msg::INVITE) {
-	gtk_list_store_set(store, &iter, COL_INFO, "Invite", -1);
-      } else if (msg.type == Msg::ACCEPT) {
-	gtk_list_store_set(store, &iter, COL_INFO, "Invite accepted", -1);
-      } else if (msg.type == Msg::SCRIPT) {
-	Script sct(ctx, msg.script);
-	gtk_list_store_set(store, &iter,
-			   COL_INFO, fmt("New script:\n%0", sct.name).c_str(),
-			   -1);
-      } else if (msg.type == Msg::POST) {
-	Post ps(ctx, msg.post);
-	Feed fd(get_feed_id(ctx, ps.feed_id));
-	
-	gtk_list_store_set(store, &iter,
-			   COL_INFO, fmt("New post in feed '%0':\n%1",
-					 fd.name, ps.body).c_str(),
-			   -1);
-      } else if (msg.type == Msg::TASK) {
-	Task tsk(ctx, msg.task);
-	Project prj(get_project_id(ctx, tsk.project_id));
-	
-	gtk_list_store_set(store, &iter,
-			   COL_INFO, fmt("New task in project '%0':\n%1",
-					 prj.name, tsk.name).c_str(),
-			   -1);
-      } else {
-	gtk_list_store_set(store, &iter,
-			   COL_INFO, fmt("Invalid message type: %0",
-					 msg.type).c_str(),
-			   -1);
-      }
+    clear(store);
 
-      cnt++;
+    for (auto &key: ctx.db.inbox_sort.recs) {
+      append(store, ctx.db.inbox, *key.second);
     }
 
-    if (cnt) {
+    if (size(store)) {
       sel_first(GTK_TREE_VIEW(lst));
       gtk_widget_grab_focus(lst);
     }
@@ -1,12 +1,13 @@
 #ifndef SNACKIS_GUI_INBOX_HPP
 #define SNACKIS_GUI_INBOX_HPP
 
+#include "snackis/gui/rec_model.hpp"
 #include "snackis/gui/view.hpp"
 
 namespace snackis {
 namespace gui {
   struct Inbox: View {
-    GtkListStore *store;
+    RecModel *store;
     GtkWidget *lst, *dismiss_btn, *cancel_btn;
 
     Inbox(Ctx &ctx);
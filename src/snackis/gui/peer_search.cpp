@@ -12,14 +12,20 @@ namespace gui {
     push_view(new PeerView(Peer(ctx, rec)));
   }  
 
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Peer> &rec) {
+    Peer peer(ctx, rec);
+    
+    return {id_str(peer),
+	    fmt("%0\n%1", peer.name, peer.email),
+	    join(peer.tags.begin(), peer.tags.end(), '\n'),
+	    peer.info};
+  }
+
   PeerSearch::PeerSearch(Ctx &ctx):
     SearchView<Peer>(ctx, "Peer",
-		     gtk_list_store_new(5,
-					G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Peer>(4, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     active_fld(gtk_check_button_new_with_label("Active")),
@@ -55,51 +61,23 @@ namespace gui {
   }
 
   void PeerSearch::find() {
-    size_t cnt(0);    
     str id_sel(trim(gtk_entry_get_text(GTK_ENTRY(id_fld))));
     bool active_sel(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(active_fld)));
     str tags_str(get_str(GTK_ENTRY(tags_fld)));
     std::set<str> tags_sel(word_set(tags_str));
     str text_sel(trim(gtk_entry_get_text(GTK_ENTRY(text_fld))));
     
-    for (const auto &key: ctx.db.peers_sort.recs) {
-      auto &rec(db::get(ctx.db.peers, key.second));
-      Peer peer(ctx, rec);
-
-      if (!id_sel.empty() && find_ci(id_str(peer), id_sel) == str::npos) {
-	continue;
-      }
-
-      if (peer.active != active_sel) { continue; }
-
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    peer.tags.begin(), peer.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!text_sel.empty() &&
-	  find_ci(peer.name, text_sel) == str::npos &&
-	  find_ci(peer.email, text_sel) == str::npos &&
-	  find_ci(peer.info, text_sel) == str::npos) {
-	continue;
-      }
-
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(peer).c_str(),
-			 COL_NAME, fmt("%0\n%1", peer.name, peer.email).c_str(),
-			 COL_TAGS,
-			 join(peer.tags.begin(), peer.tags.end(), '\n').c_str(),
-			 COL_INFO, peer.info.c_str(),
-			 -1);
-      cnt++;
+    db::Query<Peer> q;
+    add(q, db::eq(peer_active, active_sel));
+    if (!id_sel.empty()) { add(q, id_like(peer_id, id_sel)); }
+    if (!tags_sel.empty()) { add(q, db::has_all(peer_tags, tags_sel)); }
+    
+    if (!text_sel.empty()) {
+      add(q, db::any({db::contains_ci(peer_name, text_sel),
+		      db::contains_ci(peer_email, text_sel),
+		      db::contains_ci(peer_info, text_sel)}));
     }
-
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    
+    search(*this, ctx.db.peers, ctx.db.peers_sort, q);
   }
 }}
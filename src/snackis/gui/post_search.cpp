@@ -13,14 +13,24 @@ namespace gui {
     push_view(new PostView(post));
   }
 
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Post> &rec) {
+    Post post(ctx, rec);
+    auto pr(get_peer_id(ctx, post.owner_id));
+    
+    return {id_str(post),
+	    trim(fmt("%0\n%1",
+		     pr.name,
+		     fmt(post.created_at, "%a %b %d, %H:%M").c_str())),
+	    join(post.tags.begin(), post.tags.end(), '\n'),
+	    post.body};
+  }
+
   PostSearch::PostSearch(Ctx &ctx):
     SearchView<Post>(ctx,
 		     "Post",
-		     gtk_list_store_new(5, G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Post>(4, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     tags_fld(gtk_entry_new()),
@@ -80,12 +90,10 @@ namespace gui {
   }
 
   void PostSearch::find() {
-    size_t cnt(0);
-    
     str id_sel(trim(gtk_entry_get_text(GTK_ENTRY(id_fld))));
     str tags_str(trim(gtk_entry_get_text(GTK_ENTRY(tags_fld))));
     std::set<str> tags_sel(word_set(tags_str));
-    str body_sel(trim(gtk_entry_get_text(GTK_ENTRY(body_fld))));
+    auto body_sel(db::tokenize(gtk_entry_get_text(GTK_ENTRY(body_fld))));
     auto feed_sel(feed_fld.selected);
     auto peer_sel(peer_fld.selected);
     str min_time_str(trim(gtk_entry_get_text(GTK_ENTRY(min_time_fld))));
@@ -106,66 +114,21 @@ namespace gui {
       return;
     }
 
-    auto me(whoamid(ctx));
-    
-    for (auto key = ctx.db.posts_sort.recs.rbegin();
-	 key != ctx.db.posts_sort.recs.rend();
-	 key++) {
-      auto &rec(db::get(ctx.db.posts, key->second));
-      Post post(ctx, rec);
-      Feed feed(get_feed_id(ctx, post.feed_id));
-
-      if (!id_sel.empty() && find_ci(id_str(post), id_sel) == str::npos) {
-	continue;
-      }
-
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    post.tags.begin(), post.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!body_sel.empty() && find_ci(post.body, body_sel) == str::npos) {
-	continue;
-      }
-
-      if (!min_time_str.empty() && post.created_at < *min_time_sel) {
-	continue;
-      }
-
-      if (!max_time_str.empty() && post.created_at > *max_time_sel) {
-	continue;
-      }
-      
-      if (feed_sel && post.feed_id != feed_sel->id) { continue; }
-
-      if (peer_sel &&
-	  post.owner_id != peer_sel->id &&
-	  (post.owner_id != me ||
-	   post.peer_ids.find(peer_sel->id) == post.peer_ids.end())) {
-	continue;
-      }
-      
-      auto pr(get_peer_id(ctx, post.owner_id));
-      
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      const str by(trim(fmt("%0\n%1",
-			    pr.name,
-			    fmt(post.created_at, "%a %b %d, %H:%M").c_str())));
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(post).c_str(),
-			 COL_BY, by.c_str(),
-			 COL_TAGS,
-			 join(post.tags.begin(), post.tags.end(), '\n').c_str(),
-			 COL_BODY, post.body.c_str(),
-			 -1);
-      cnt++;
+    db::Query<Post> q(true);
+    if (!id_sel.empty()) { add(q, id_like(post_id, id_sel)); }
+    if (min_time_sel || max_time_sel) {
+      add(q, db::range(post_created_at, min_time_sel, max_time_sel));
     }
-
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    if (!tags_sel.empty()) { narrow(q, db::find(ctx.db.posts_tags, tags_sel)); }
+    if (!body_sel.empty()) { narrow(q, db::search(ctx.db.posts_text, body_sel)); }
+    if (feed_sel) { add(q, db::eq(post_feed_id, feed_sel->id)); }
+
+    if (peer_sel) {
+      add(q, db::any({db::eq(post_owner_id, peer_sel->id),
+		      db::all({db::eq(post_owner_id, whoamid(ctx)),
+			       db::has(post_peer_ids, peer_sel->id)})}));
+    }
+    
+    search(*this, ctx.db.posts, ctx.db.posts_sort, q);
   }
 }}
@@ -11,17 +11,24 @@ namespace gui {
   static void edit(Ctx &ctx, const db::Rec<Project> &rec) {
     push_view(new ProjectView(Project(ctx, rec)));
   }
+
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Project> &rec) {
+    Project project(ctx, rec);
+    Peer own(get_peer_id(ctx, project.owner_id));
+    
+    return {id_str(project),
+	    fmt(project.created_at, "%a %b %d, %H:%M"),
+	    own.name,
+	    join(project.tags.begin(), project.tags.end(), '\n'),
+	    trim(fmt("%0\n%1", project.name, project.info))};
+  }
   
   ProjectSearch::ProjectSearch(Ctx &ctx):
     SearchView<Project>(ctx,
 		     "Project",
-		     gtk_list_store_new(6,
-					G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Project>(5, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     active_fld(gtk_check_button_new_with_label("Active")),
@@ -63,8 +70,6 @@ namespace gui {
   }
 
   void ProjectSearch::find() {
-    size_t cnt(0);
-    
     str id_sel(trim(gtk_entry_get_text(GTK_ENTRY(id_fld))));
     bool active_sel(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(active_fld)));
     str tags_str(trim(gtk_entry_get_text(GTK_ENTRY(tags_fld))));
@@ -72,54 +77,21 @@ namespace gui {
     str text_sel(trim(gtk_entry_get_text(GTK_ENTRY(text_fld)))); 
     auto &peer_sel(peer_fld.selected);
     
-    for (const auto &key: ctx.db.projects_sort.recs) {
-      auto &rec(db::get(ctx.db.projects, key.second));
-      Project project(ctx, rec);
-
-      if (!id_sel.empty() && find_ci(id_str(project), id_sel) == str::npos) {
-	continue;
-      }
-
-      if (project.active != active_sel) { continue; }
-
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    project.tags.begin(), project.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!text_sel.empty() &&
-	  find_ci(project.name, text_sel) == str::npos &&
-	  find_ci(project.info, text_sel) == str::npos) {
-	continue;
-      }
-
-      if (peer_sel &&
-	  project.owner_id != peer_sel->id &&
-	  project.peer_ids.find(peer_sel->id) == project.peer_ids.end()) {
-	continue;
-      }
-      
-      Peer own(get_peer_id(ctx, project.owner_id));
-
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(project).c_str(),
-			 COL_CREATED,
-			 fmt(project.created_at, "%a %b %d, %H:%M").c_str(),
-			 COL_OWNER, own.name.c_str(),
-			 COL_TAGS,
-			 join(project.tags.begin(), project.tags.end(), '\n').c_str(),
-			 COL_INFO, trim(fmt("%0\n%1",
-					    project.name, project.info)).c_str(), 
-			 -1);
-      cnt++;
+    db::Query<Project> q;
+    add(q, db::eq(project_active, active_sel));
+    if (!id_sel.empty()) { add(q, id_like(project_id, id_sel)); }
+    if (!tags_sel.empty()) { narrow(q, db::find(ctx.db.projects_tags, tags_sel)); }
+    
+    if (!text_sel.empty()) {
+      add(q, db::any({db::contains_ci(project_name, text_sel),
+		      db::contains_ci(project_info, text_sel)}));
     }
 
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    if (peer_sel) {
+      add(q, db::any({db::eq(project_owner_id, peer_sel->id),
+		      db::has(project_peer_ids, peer_sel->id)}));
+    }
+    
+    search(*this, ctx.db.projects, ctx.db.projects_sort, q);
   }
 }}
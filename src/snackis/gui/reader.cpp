@@ -74,7 +74,7 @@ namespace gui {
 	auto id(*snabel::get<snabel::StrRef>(args[0]));
 	gui::set_str(GTK_ENTRY(v->id_fld), id);
 	
-	if (find(*v) == 1) {
+	if (find_wait(*v) == 1) {
 	  auto rec(first_rec(*v));
 	  CHECK(rec != nullptr, _);
 	  push_view(new ViewT(RecT(ctx, *rec)));
@@ -120,6 +120,20 @@ namespace gui {
 		     rewrite_db(ctx) / 1000));
       });
 
+    add_cmd(rdr, "db-stats", {}, [&ctx](auto args) {
+	log(ctx, db::fmt_stats(ctx.proc.write_loop));
+	log(ctx, db::fmt_slurp_stats(ctx));
+      });
+
+    add_cmd(rdr, "search-stats", {}, [&ctx](auto args) {
+	log(ctx, fmt_search_stats());
+      });
+
+    add_cmd(rdr, "compact-db", {}, [&ctx](auto args) {
+	db::compact(ctx);
+	log(ctx, "Compacting database in the background...");
+      });
+
     add_cmd(rdr, "encrypt", {}, [&ctx](auto args) {
 	push_view(new Encrypt(ctx));
       });
@@ -139,7 +153,7 @@ namespace gui {
     add_cmd(rdr, "inbox", {}, [&ctx](auto args) {
 	refresh(ctx);
 
-	if (ctx.db.inbox.recs.empty()) {
+	if (ctx.db.inbox.recs->empty()) {
 	  log(ctx, "Inbox is empty");
 	} else {
 	  if (!inbox) { inbox.reset(new Inbox(ctx)); }
@@ -178,7 +192,7 @@ namespace gui {
     init_search<ProjectSearch>(rdr, "project");
 
     add_cmd(rdr, "send", {}, [&ctx](auto args) {
-	if (ctx.db.outbox.recs.empty()) {
+	if (ctx.db.outbox.recs->empty()) {
 	  log(ctx, "Nothing to send");
 	} else {
 	  smtp_worker->go.notify_one();
@@ -0,0 +1,260 @@
+#include <new>
+#include "snackis/core/error.hpp"
+#include "snackis/gui/rec_model.hpp"
+
+namespace snackis {
+namespace gui {
+  RecRow::RecRow(std::shared_ptr<const void> rec, RecRow *parent, size_t pos):
+    rec(rec), parent(parent), pos(pos)
+  { }
+
+  static void rec_model_iface_init(GtkTreeModelIface *iface);
+
+  G_DEFINE_TYPE_WITH_CODE(RecModel, rec_model, G_TYPE_OBJECT,
+			  G_IMPLEMENT_INTERFACE(GTK_TYPE_TREE_MODEL,
+						rec_model_iface_init));
+
+  static void rec_model_init(RecModel *m) {
+    m->stamp = g_random_int();
+    m->n_cols = 0;
+    new (&m->fmt) RowFmt();
+    new (&m->root) RecRow(nullptr, nullptr, 0);
+    m->cached = nullptr;
+    new (&m->cache) std::vector<str>();
+  }
+
+  static void rec_model_finalize(GObject *obj) {
+    auto m(reinterpret_cast<RecModel *>(obj));
+    m->cache.~vector();
+    m->root.~RecRow();
+    m->fmt.~RowFmt();
+    G_OBJECT_CLASS(rec_model_parent_class)->finalize(obj);
+  }
+
+  static void rec_model_class_init(RecModelClass *cls) {
+    G_OBJECT_CLASS(cls)->finalize = rec_model_finalize;
+  }
+
+  static RecModel *get_model(GtkTreeModel *mod) {
+    return reinterpret_cast<RecModel *>(mod);
+  }
+
+  static RecRow *get_row(RecModel *m, GtkTreeIter *it) {
+    if (!it) { return &m->root; }
+    CHECK(it->stamp == m->stamp, _);
+    return static_cast<RecRow *>(it->user_data);
+  }
+
+  static gboolean set_iter(RecModel *m, RecRow *row, GtkTreeIter *it) {
+    it->stamp = m->stamp;
+    it->user_data = row;
+    return true;
+  }
+
+  static gboolean clear_iter(GtkTreeIter *it) {
+    it->stamp = 0;
+    return false;
+  }
+
+  static GtkTreePath *get_path(const RecRow *row) {
+    GtkTreePath *pth(gtk_tree_path_new());
+
+    for (; row->parent; row = row->parent) {
+      gtk_tree_path_prepend_index(pth, row->pos);
+    }
+
+    return pth;
+  }
+
+  static GtkTreeModelFlags get_flags(GtkTreeModel *mod) {
+    return GTK_TREE_MODEL_ITERS_PERSIST;
+  }
+
+  static gint get_n_columns(GtkTreeModel *mod) {
+    return get_model(mod)->n_cols + 1;
+  }
+
+  static GType get_column_type(GtkTreeModel *mod, gint col) {
+    return col ? G_TYPE_STRING : G_TYPE_POINTER;
+  }
+
+  static gboolean get_iter(GtkTreeModel *mod,
+			   GtkTreeIter *it,
+			   GtkTreePath *pth) {
+    auto m(get_model(mod));
+    RecRow *row(&m->root);
+    gint depth(0);
+    gint *idxs(gtk_tree_path_get_indices_with_depth(pth, &depth));
+
+    for (gint i(0); i < depth; i++) {
+      if (idxs[i] < 0 || size_t(idxs[i]) >= row->rows.size()) {
+	return clear_iter(it);
+      }
+
+      row = row->rows[idxs[i]].get();
+    }
+
+    return (row == &m->root) ? clear_iter(it) : set_iter(m, row, it);
+  }
+
+  static GtkTreePath *get_path(GtkTreeModel *mod, GtkTreeIter *it) {
+    return get_path(get_row(get_model(mod), it));
+  }
+
+  static void get_value(GtkTreeModel *mod,
+			GtkTreeIter *it,
+			gint col,
+			GValue *val) {
+    auto m(get_model(mod));
+    auto row(get_row(m, it));
+
+    if (!col) {
+      g_value_init(val, G_TYPE_POINTER);
+      g_value_set_pointer(val, const_cast<void *>(row->rec.get()));
+      return;
+    }
+
+    if (m->cached != row) {
+      m->cache = m->fmt(row->rec.get());
+      m->cached = row;
+    }
+
+    g_value_init(val, G_TYPE_STRING);
+    const size_t i(col-1);
+    g_value_set_string(val, (i < m->cache.size()) ? m->cache[i].c_str() : "");
+  }
+
+  static gboolean iter_next(GtkTreeModel *mod, GtkTreeIter *it) {
+    auto m(get_model(mod));
+    auto row(get_row(m, it));
+    auto &rows(row->parent->rows);
+    if (row->pos+1 >= rows.size()) { return clear_iter(it); }
+    return set_iter(m, rows[row->pos+1].get(), it);
+  }
+
+  static gboolean iter_previous(GtkTreeModel *mod, GtkTreeIter *it) {
+    auto m(get_model(mod));
+    auto row(get_row(m, it));
+    if (!row->pos) { return clear_iter(it); }
+    return set_iter(m, row->parent->rows[row->pos-1].get(), it);
+  }
+
+  static gboolean iter_nth_child(GtkTreeModel *mod,
+				 GtkTreeIter *it,
+				 GtkTreeIter *parent,
+				 gint n) {
+    auto m(get_model(mod));
+    auto &rows(get_row(m, parent)->rows);
+    if (n < 0 || size_t(n) >= rows.size()) { return clear_iter(it); }
+    return set_iter(m, rows[n].get(), it);
+  }
+
+  static gboolean iter_children(GtkTreeModel *mod,
+				GtkTreeIter *it,
+				GtkTreeIter *parent) {
+    return iter_nth_child(mod, it, parent, 0);
+  }
+
+  static gboolean iter_has_child(GtkTreeModel *mod, GtkTreeIter *it) {
+    return !get_row(get_model(mod), it)->rows.empty();
+  }
+
+  static gint iter_n_children(GtkTreeModel *mod, GtkTreeIter *it) {
+    return get_row(get_model(mod), it)->rows.size();
+  }
+
+  static gboolean iter_parent(GtkTreeModel *mod,
+			      GtkTreeIter *it,
+			      GtkTreeIter *child) {
+    auto m(get_model(mod));
+    auto row(get_row(m, child));
+    if (row->parent == &m->root) { return clear_iter(it); }
+    return set_iter(m, row->parent, it);
+  }
+
+  static void rec_model_iface_init(GtkTreeModelIface *iface) {
+    iface->get_flags = get_flags;
+    iface->get_n_columns = get_n_columns;
+    iface->get_column_type = get_column_type;
+    iface->get_iter = get_iter;
+    iface->get_path = get_path;
+    iface->get_value = get_value;
+    iface->iter_next = iter_next;
+    iface->iter_previous = iter_previous;
+    iface->iter_children = iter_children;
+    iface->iter_has_child = iter_has_child;
+    iface->iter_n_children = iter_n_children;
+    iface->iter_nth_child = iter_nth_child;
+    iface->iter_parent = iter_parent;
+  }
+
+  RecModel *new_rec_model(int n_cols, RowFmt fmt) {
+    auto m(static_cast<RecModel *>(g_object_new(rec_model_get_type(),
+						nullptr)));
+    m->n_cols = n_cols;
+    m->fmt = fmt;
+    return m;
+  }
+
+  RecRow *append(RecModel *m,
+		 std::shared_ptr<const void> rec,
+		 RecRow *parent) {
+    if (!parent) { parent = &m->root; }
+    auto &rows(parent->rows);
+    rows.emplace_back(new RecRow(rec, parent, rows.size()));
+    auto row(rows.back().get());
+
+    GtkTreeIter it;
+    set_iter(m, row, &it);
+    GtkTreePath *pth(get_path(row));
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(m), pth, &it);
+
+    if (parent != &m->root && rows.size() == 1) {
+      set_iter(m, parent, &it);
+      gtk_tree_path_up(pth);
+      gtk_tree_model_row_has_child_toggled(GTK_TREE_MODEL(m), pth, &it);
+    }
+
+    gtk_tree_path_free(pth);
+    return row;
+  }
+
+  void remove(RecModel *m, GtkTreeIter &it) {
+    auto row(get_row(m, &it));
+    auto parent(row->parent);
+    auto &rows(parent->rows);
+    const size_t pos(row->pos);
+    GtkTreePath *pth(get_path(row));
+
+    m->cached = nullptr;
+    rows.erase(rows.begin() + pos);
+    for (size_t i(pos); i < rows.size(); i++) { rows[i]->pos = i; }
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(m), pth);
+
+    if (parent != &m->root && rows.empty()) {
+      GtkTreeIter pit;
+      set_iter(m, parent, &pit);
+      gtk_tree_path_up(pth);
+      gtk_tree_model_row_has_child_toggled(GTK_TREE_MODEL(m), pth, &pit);
+    }
+
+    gtk_tree_path_free(pth);
+    clear_iter(&it);
+  }
+
+  void clear(RecModel *m) {
+    auto &rows(m->root.rows);
+    m->cached = nullptr;
+
+    while (!rows.empty()) {
+      rows.pop_back();
+      GtkTreePath *pth(gtk_tree_path_new_from_indices(rows.size(), -1));
+      gtk_tree_model_row_deleted(GTK_TREE_MODEL(m), pth);
+      gtk_tree_path_free(pth);
+    }
+
+    m->stamp++;
+  }
+
+  size_t size(const RecModel *m) { return m->root.rows.size(); }
+}}
@@ -0,0 +1,69 @@
+#ifndef SNACKIS_GUI_REC_MODEL_HPP
+#define SNACKIS_GUI_REC_MODEL_HPP
+
+#include <memory>
+#include <vector>
+#include <gtk/gtk.h>
+
+#include "snackis/core/func.hpp"
+#include "snackis/core/str.hpp"
+#include "snackis/db/rec.hpp"
+#include "snackis/db/table.hpp"
+
+namespace snackis {
+namespace gui {
+  using RowFmt = func<std::vector<str> (const void *)>;
+
+  struct RecRow {
+    std::shared_ptr<const void> rec;
+    RecRow *parent;
+    size_t pos;
+    std::vector<std::unique_ptr<RecRow>> rows;
+
+    RecRow(std::shared_ptr<const void> rec, RecRow *parent, size_t pos);
+  };
+
+  struct RecModel {
+    GObject parent;
+    gint stamp;
+    int n_cols;
+    RowFmt fmt;
+    RecRow root;
+    const RecRow *cached;
+    std::vector<str> cache;
+  };
+
+  struct RecModelClass {
+    GObjectClass parent;
+  };
+
+  GType rec_model_get_type();
+
+  RecModel *new_rec_model(int n_cols, RowFmt fmt);
+
+  template <typename RecT>
+  RecModel *new_rec_model(int n_cols,
+			  func<std::vector<str> (const db::Rec<RecT> &)> fmt) {
+    return new_rec_model(n_cols, [fmt](const void *rec) {
+	return fmt(*static_cast<const db::Rec<RecT> *>(rec));
+      });
+  }
+
+  RecRow *append(RecModel *m,
+		 std::shared_ptr<const void> rec,
+		 RecRow *parent=nullptr);
+
+  template <typename RecT, typename...KeyT>
+  RecRow *append(RecModel *m,
+		 const db::Table<RecT, KeyT...> &tbl,
+		 const db::Rec<RecT> &rec,
+		 RecRow *parent=nullptr) {
+    return append(m, db::get_row(tbl, rec), parent);
+  }
+
+  void remove(RecModel *m, GtkTreeIter &it);
+  void clear(RecModel *m);
+  size_t size(const RecModel *m);
+}}
+
+#endif
@@ -11,17 +11,24 @@ namespace gui {
   static void edit(Ctx &ctx, const db::Rec<Script> &rec) {
     push_view(new ScriptView(Script(ctx, rec)));
   }
+
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Script> &rec) {
+    Script script(ctx, rec);
+    Peer own(get_peer_id(ctx, script.owner_id));
+    
+    return {id_str(script),
+	    fmt(script.created_at, "%a %b %d, %H:%M"),
+	    own.name,
+	    join(script.tags.begin(), script.tags.end(), '\n'),
+	    script.name};
+  }
   
   ScriptSearch::ScriptSearch(Ctx &ctx):
     SearchView<Script>(ctx,
 		     "Script",
-		     gtk_list_store_new(6,
-					G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Script>(5, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     tags_fld(gtk_entry_new()),
@@ -59,57 +66,22 @@ namespace gui {
   }
 
   void ScriptSearch::find() {
-    size_t cnt(0);
-    
     str id_sel(trim(gtk_entry_get_text(GTK_ENTRY(id_fld))));
     str tags_str(trim(gtk_entry_get_text(GTK_ENTRY(tags_fld))));
     std::set<str> tags_sel(word_set(tags_str));
-    str code_sel(trim(gtk_entry_get_text(GTK_ENTRY(code_fld)))); 
+    auto code_sel(db::tokenize(gtk_entry_get_text(GTK_ENTRY(code_fld))));
     auto &peer_sel(peer_fld.selected);
     
-    for (const auto &key: ctx.db.scripts_sort.recs) {
-      auto &rec(db::get(ctx.db.scripts, key.second));
-      Script script(ctx, rec);
-
-      if (!id_sel.empty() && find_ci(id_str(script), id_sel) == str::npos) {
-	continue;
-      }
+    db::Query<Script> q;
+    if (!id_sel.empty()) { add(q, id_like(script_id, id_sel)); }
+    if (!tags_sel.empty()) { narrow(q, db::find(ctx.db.scripts_tags, tags_sel)); }
+    if (!code_sel.empty()) { narrow(q, db::search(ctx.db.scripts_text, code_sel)); }
 
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    script.tags.begin(), script.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!code_sel.empty() && find_ci(script.code, code_sel) == str::npos) {
-	continue;
-      }
-
-      if (peer_sel &&
-	  script.owner_id != peer_sel->id &&
-	  script.peer_ids.find(peer_sel->id) == script.peer_ids.end()) {
-	continue;
-      }
-      
-      Peer own(get_peer_id(ctx, script.owner_id));
-
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(script).c_str(),
-			 COL_CREATED,
-			 fmt(script.created_at, "%a %b %d, %H:%M").c_str(),
-			 COL_OWNER, own.name.c_str(),
-			 COL_TAGS,
-			 join(script.tags.begin(), script.tags.end(), '\n').c_str(),
-			 COL_NAME, script.name.c_str(), 
-			 -1);
-      cnt++;
+    if (peer_sel) {
+      add(q, db::any({db::eq(script_owner_id, peer_sel->id),
+		      db::has(script_peer_ids, peer_sel->id)}));
     }
-
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    
+    search(*this, ctx.db.scripts, ctx.db.scripts_sort, q);
   }
 }}
@@ -0,0 +1,20 @@
+#include "snackis/core/hist.hpp"
+#include "snackis/gui/search_view.hpp"
+
+namespace snackis {
+namespace gui {
+  static Hist search_usecs;
+  
+  Pool &get_search_pool() {
+    static Pool pool(1, SEARCH_QUEUE);
+    return pool;
+  }
+
+  void add_search_usecs(int64_t usecs) {
+    add(search_usecs, usecs);
+  }
+
+  str fmt_search_stats() {
+    return fmt("Search latency (us): %0", search_usecs);
+  }
+}}
@@ -1,35 +1,224 @@
 #ifndef SNACKIS_GUI_SEARCH_VIEW_HPP
 #define SNACKIS_GUI_SEARCH_VIEW_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "snackis/core/error.hpp"
 #include "snackis/core/func.hpp"
+#include "snackis/core/opt.hpp"
+#include "snackis/core/pool.hpp"
+#include "snackis/core/time.hpp"
+#include "snackis/db/query.hpp"
+#include "snackis/db/table.hpp"
 #include "snackis/gui/gui.hpp"
+#include "snackis/gui/rec_model.hpp"
 #include "snackis/gui/view.hpp"
 
 namespace snackis {
 namespace gui {
+  const size_t SEARCH_BATCH(100), SEARCH_QUEUE(16);
+
+  template <typename RecT>
+  struct SearchView;
+
+  template <typename RecT>
+  struct SearchJob {
+    using Row = std::shared_ptr<const db::Rec<RecT>>;
+    using Collect = func<std::vector<Row> ()>;
+    using Sort = func<void (std::vector<Row> &)>;
+
+    SearchView<RecT> &view;
+    db::Query<RecT> query;
+    // Both run in the search pool unless waiting
+    opt<Collect> collect;
+    opt<Sort> sort;
+    PTime start;
+    std::atomic<bool> canceled;
+
+    SearchJob(SearchView<RecT> &view, const db::Query<RecT> &query);
+  };
+
+  template <typename RecT>
+  struct SearchBatch {
+    std::shared_ptr<SearchJob<RecT>> job;
+    std::vector<typename SearchJob<RecT>::Row> rows;
+    bool done;
+  };
+
   template <typename RecT>
   struct SearchView: View {
     using OnActivate = func<void (const db::Rec<RecT> &)>;
-    GtkListStore *store;
+    RecModel *store;
     GtkWidget *fields, *find_btn, *list, *cancel_btn;
     OnActivate on_activate;
-    bool close_on_activate;
+    bool close_on_activate, wait, watching;
+    std::shared_ptr<SearchJob<RecT>> job;
     
-    SearchView(Ctx &ctx, const str &type, GtkListStore *store, OnActivate act);
+    SearchView(Ctx &ctx, const str &type, RecModel *store, OnActivate act);
+    ~SearchView();
+    void load() override;
     virtual void find()=0;
   };
 
+  Pool &get_search_pool();
+  void add_search_usecs(int64_t usecs);
+  str fmt_search_stats();
+
+  template <typename RecT>
+  SearchJob<RecT>::SearchJob(SearchView<RecT> &view,
+			     const db::Query<RecT> &query):
+    view(view), query(query), start(pnow()), canceled(false)
+  {
+    this->query.hits.reset();
+  }
+
   template <typename RecT>
-  size_t find(SearchView<RecT> &v) {
+  void cancel(SearchView<RecT> &v) {
+    if (v.job) {
+      v.job->canceled = true;
+      v.job.reset();
+    }
+  }
+
+  template <typename RecT>
+  gboolean on_search_batch(gpointer data) {
+    std::unique_ptr<SearchBatch<RecT>> b(static_cast<SearchBatch<RecT> *>(data));
+    auto &j(*b->job);
+    if (j.canceled) { return false; }
+    auto &v(j.view);
+    const bool first(!size(v.store));
+    for (auto &r: b->rows) { append(v.store, r); }
+    if (first && size(v.store)) { sel_first(GTK_TREE_VIEW(v.list)); }
+    
+    if (b->done) {
+      add_search_usecs(usecs(pnow()-j.start));
+      v.job.reset();
+      
+      if (v.visible) {
+	gtk_widget_grab_focus(size(v.store) ? v.list : v.focused);
+      }
+    }
+    
+    return false;
+  }
+
+  template <typename RecT, typename FnT>
+  void run(SearchJob<RecT> &j, FnT deliver) {
+    using Row = typename SearchJob<RecT>::Row;
+    std::vector<Row> rows, hits, batch;
+    if (j.collect) { rows = (*j.collect)(); }
+
+    auto push([&batch, &deliver](const Row &r) {
+	batch.push_back(r);
+	
+	if (batch.size() == SEARCH_BATCH) {
+	  deliver(batch, false);
+	  batch.clear();
+	}
+      });
+    
+    for (auto &r: rows) {
+      if (j.canceled) { return; }
+      if (!match(j.query, *r)) { continue; }
+      
+      if (j.sort) {
+	hits.push_back(r);
+      } else {
+	push(r);
+      }
+    }
+
+    if (j.sort) {
+      (*j.sort)(hits);
+      
+      for (auto &r: hits) {
+	if (j.canceled) { return; }
+	push(r);
+      }
+    }
+
+    deliver(batch, true);
+  }
+
+  template <typename RecT, typename...TblKeyT, typename...KeyT>
+  void search(SearchView<RecT> &v,
+	      const db::Table<RecT, TblKeyT...> &tbl,
+	      const db::SortIndex<RecT, KeyT...> &idx,
+	      const db::Query<RecT> &q) {
+    using Job = SearchJob<RecT>;
+    using Row = typename Job::Row;
+    using Hit = std::pair<typename db::SortIndex<RecT, KeyT...>::Key::Type, Row>;
+    auto j(std::make_shared<Job>(v, q));
+
+    // Shared recs keep rows alive and unchanged, writes copy the map
+    auto recs(tbl.recs);
+    
+    if (q.hits) {
+      auto hits(*q.hits);
+      
+      j->collect.emplace([recs, hits]() {
+	  std::vector<Row> rows;
+	  rows.reserve(hits.size());
+	  for (auto rec: hits) { rows.push_back(rec->shared_from_this()); }
+	  return rows;
+	});
+    } else {
+      j->collect.emplace([recs]() {
+	  std::vector<Row> rows;
+	  rows.reserve(recs->size());
+	  for (auto &r: *recs) { rows.push_back(r.second); }
+	  return rows;
+	});
+    }
+
+    auto key(idx.key);
+    const bool rev(q.rev);
+      
+    j->sort.emplace([key, rev](auto &rows) {
+	std::vector<Hit> hits;
+	hits.reserve(rows.size());
+	for (auto &r: rows) { hits.emplace_back(key(*r), r); }
+	  
+	std::sort(hits.begin(), hits.end(), [rev](auto &x, auto &y) {
+	    return rev ? y.first < x.first : x.first < y.first;
+	  });
+
+	for (size_t i(0); i < hits.size(); i++) { rows[i] = hits[i].second; }
+      });
+
+    v.job = j;
+
+    if (v.wait) {
+      run(*j, [j](auto &rows, bool done) {
+	  on_search_batch<RecT>(new SearchBatch<RecT> {j, rows, done});
+	});
+    } else {
+      post(get_search_pool(), [j]() {
+	  run(*j, [j](auto &rows, bool done) {
+	      g_idle_add(on_search_batch<RecT>,
+			 new SearchBatch<RecT> {j, rows, done});
+	    });
+	});
+    }
+  }
+
+  template <typename RecT>
+  void find(SearchView<RecT> &v, bool wait=false) {
     TRY(try_find);
-    gtk_list_store_clear(v.store);
+    cancel(v);
+    clear(v.store);
     refresh(v.ctx);
+    v.wait = wait;
     v.find();
+  }
 
-    auto cnt(gtk_tree_model_iter_n_children(GTK_TREE_MODEL(v.store), nullptr));
-    if (cnt) { sel_first(GTK_TREE_VIEW(v.list)); }
-    return cnt;
+  template <typename RecT>
+  size_t find_wait(SearchView<RecT> &v) {
+    find(v, true);
+    return size(v.store);
   }
   
   template <typename RecT>
@@ -37,6 +226,24 @@ namespace gui {
     find(*v);
   }
 
+  template <typename RecT>
+  void on_search_change(gpointer *_, SearchView<RecT> *v) {
+    cancel(*v);
+  }
+
+  template <typename RecT>
+  void watch_fields(GtkWidget *w, gpointer v) {
+    if (GTK_IS_EDITABLE(w) || GTK_IS_COMBO_BOX(w)) {
+      g_signal_connect(w, "changed", G_CALLBACK(on_search_change<RecT>), v);
+    } else if (GTK_IS_TOGGLE_BUTTON(w)) {
+      g_signal_connect(w, "toggled", G_CALLBACK(on_search_change<RecT>), v);
+    }
+
+    if (GTK_IS_CONTAINER(w)) {
+      gtk_container_forall(GTK_CONTAINER(w), watch_fields<RecT>, v);
+    }
+  }
+
   template <typename RecT>
   void activate(SearchView<RecT> *v) {
     TRY(try_activate);
@@ -77,7 +284,7 @@ namespace gui {
   template <typename RecT>
   SearchView<RecT>::SearchView(Ctx &ctx,
 			       const str &type,
-			       GtkListStore *store,
+			       RecModel *store,
 			       OnActivate act):
     View(ctx, fmt("%0 Search", type)),
     store(store),
@@ -86,7 +293,9 @@ namespace gui {
     list(new_tree_view(GTK_TREE_MODEL(store))),
     cancel_btn(gtk_button_new_with_mnemonic("_Cancel")),
     on_activate(act),
-    close_on_activate(false)
+    close_on_activate(false),
+    wait(false),
+    watching(false)
   {
     GtkWidget *lbl;
     gtk_box_pack_start(GTK_BOX(panel), fields, false, false, 0);
@@ -120,6 +329,19 @@ namespace gui {
     gtk_container_add(GTK_CONTAINER(btns), cancel_btn);
     focused = fields;
   }
+
+  template <typename RecT>
+  SearchView<RecT>::~SearchView() {
+    cancel(*this);
+  }
+
+  template <typename RecT>
+  void SearchView<RecT>::load() {
+    if (!watching) {
+      watch_fields<RecT>(fields, this);
+      watching = true;
+    }
+  }
   
   template <typename RecT>
   const db::Rec<RecT> *first_rec(const SearchView<RecT> &v) {
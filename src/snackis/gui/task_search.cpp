@@ -13,16 +13,24 @@ namespace gui {
     push_view(new TaskView(Task(ctx, rec)));
   }
 
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Task> &rec) {
+    Task tsk(ctx, rec);
+    Peer own(get_peer_id(ctx, tsk.owner_id));
+    
+    return {id_str(tsk),
+	    fmt(tsk.created_at, "%a %b %d, %H:%M"),
+	    own.name,
+	    to_str(tsk.prio),
+	    join(tsk.tags.begin(), tsk.tags.end(), '\n'),
+	    trim(fmt("%0\n%1", tsk.name, tsk.info))};
+  }
+
   TaskSearch::TaskSearch(Ctx &ctx):
     SearchView<Task>(ctx,
 		     "Task",
-		     gtk_list_store_new(7, G_TYPE_POINTER,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING,
-					G_TYPE_STRING),
+		     new_rec_model<Task>(6, [&ctx](auto &rec) {
+			 return fmt_row(ctx, rec);
+		       }),
 		     [&ctx](auto &rec) { edit(ctx, rec); }),
     id_fld(new_id_field()),
     prio_fld(gtk_entry_new()),
@@ -75,63 +83,29 @@ namespace gui {
   }
 
   void TaskSearch::find() {
-    size_t cnt(0);    
-
     str id_sel(get_str(GTK_ENTRY(id_fld)));
     str prio_str(get_str(GTK_ENTRY(prio_fld)));
     int64_t prio_sel(to_int64(prio_str));
     bool done_sel(gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(done_fld)));
     str tags_str(get_str(GTK_ENTRY(tags_fld)));
     std::set<str> tags_sel(word_set(tags_str));
-    str text_sel(get_str(GTK_ENTRY(text_fld)));
+    auto text_sel(db::tokenize(get_str(GTK_ENTRY(text_fld))));
     auto peer_sel(peer_fld.selected);
     
-    for (const auto &key: ctx.db.tasks_sort.recs) {
-      auto &rec(db::get(ctx.db.tasks, key.second));
-      Task tsk(ctx, rec);
-      
-      if (!id_sel.empty() && find_ci(id_str(tsk), id_sel) == str::npos) { continue; }
-
-      if (!tags_sel.empty()) {
-	std::vector<str> diff;
-	std::set_difference(tags_sel.begin(), tags_sel.end(),
-			    tsk.tags.begin(), tsk.tags.end(),
-			    std::back_inserter(diff));
-	if (!diff.empty()) { continue; }
-      }
-      
-      if (!text_sel.empty() &&
-	  find_ci(tsk.name, text_sel) == str::npos &&
-	  find_ci(tsk.info, text_sel) == str::npos) { continue; }
-      
-      if (!prio_str.empty() && prio_sel && tsk.prio > prio_sel) { continue; }
+    auto project_sel(project_fld.selected);
 
-      if (tsk.done != done_sel) { continue; }
-      
-      auto project_sel(project_fld.selected);
-      if (project_sel && tsk.project_id != project_sel->id) { continue; }
-      
-      if (peer_sel && tsk.owner_id != peer_sel->id) { continue; }
-      
-      Project prj(get_project_id(ctx, tsk.project_id));
-      Peer own(get_peer_id(ctx, tsk.owner_id));
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_ID, id_str(tsk).c_str(),
-			 COL_CREATED,
-			 fmt(tsk.created_at, "%a %b %d, %H:%M").c_str(),
-			 COL_OWNER, own.name.c_str(),
-			 COL_PRIO, to_str(tsk.prio).c_str(),
-			 COL_TAGS,
-			 join(tsk.tags.begin(), tsk.tags.end(), '\n').c_str(),
-			 COL_INFO, trim(fmt("%0\n%1", tsk.name, tsk.info)).c_str(),
-			 -1);
-      
-      cnt++;
+    db::Query<Task> q;
+    if (!prio_str.empty() && prio_sel) {
+      add(q, db::range(task_prio, opt<int64_t>(), opt<int64_t>(prio_sel)));
     }
+    add(q, db::eq(task_done, done_sel));
+    if (!id_sel.empty()) { add(q, id_like(task_id, id_sel)); }
+    if (!tags_sel.empty()) { narrow(q, db::find(ctx.db.tasks_tags, tags_sel)); }
+    if (!text_sel.empty()) { narrow(q, db::search(ctx.db.tasks_text, text_sel)); }
+    
+    if (project_sel) { add(q, db::eq(task_project_id, project_sel->id)); }
+    if (peer_sel) { add(q, db::eq(task_owner_id, peer_sel->id)); }
     
-    gtk_widget_grab_focus(cnt ? list : id_fld);
+    search(*this, ctx.db.tasks, ctx.db.tasks_sort, q);
   }
 }}
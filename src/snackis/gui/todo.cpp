@@ -26,11 +26,20 @@ namespace gui {
     push_view(new TaskView(Task(v->ctx, *rec)));
   }
   
+  static std::vector<str> fmt_row(Ctx &ctx, const db::Rec<Task> &rec) {
+    Task tsk(ctx, rec);
+    Project prj(get_project_id(ctx, tsk.project_id));
+    
+    return {fmt("%0\n%1", prj.name, tsk.name),
+	    to_str(tsk.prio),
+	    tsk.done ? "Done!" : ""};
+  }
+
   Todo::Todo(Ctx &ctx):
     View(ctx, "Todo"),
-    store(gtk_list_store_new(4,
-			     G_TYPE_POINTER,
-			     G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING)),
+    store(new_rec_model<Task>(3, [&ctx](auto &rec) {
+	  return fmt_row(ctx, rec);
+	})),
     lst(new_tree_view(GTK_TREE_MODEL(store))),
     cancel_btn(gtk_button_new_with_mnemonic("_Cancel"))
   {
@@ -59,33 +68,21 @@ namespace gui {
 
   void Todo::load() {
     View::load();
-    gtk_list_store_clear(store);
+    clear(store);
     refresh(ctx);
-    size_t cnt(0);
     
-    for(const auto &key: ctx.db.tasks_sort.recs) {
-      auto &rec(db::get(ctx.db.tasks, key.second));
-      Task tsk(ctx, rec);
-      
-      if (tsk.tags.find("todo") == tsk.tags.end()) { continue; }
-
-      if (tsk.done &&
-	  tsk.done_at < now() - std::chrono::hours(TODO_DONE_DAYS*24)) {
-	continue;
-      }
-	
-      GtkTreeIter iter;
-      gtk_list_store_append(store, &iter);
-      Project prj(get_project_id(ctx, tsk.project_id));
-      
-      gtk_list_store_set(store, &iter,
-			 COL_PTR, &rec,
-			 COL_INFO, fmt("%0\n%1", prj.name, tsk.name).c_str(),
-			 COL_PRIO, to_str(tsk.prio).c_str(),
-			 COL_DONE, tsk.done ? "Done!" : "",
-			 -1);
-      cnt++;
-    }
+    const Time min_done(now() - std::chrono::hours(TODO_DONE_DAYS*24));
+    db::Query<Task> q;
+    narrow(q, db::find(ctx.db.tasks_tags, {"todo"}));
+    
+    add(q, db::Pred<Task>([min_done](auto &rec) {
+	  return !db::get_val(rec, task_done) ||
+	    db::get_val(rec, task_done_at) >= min_done;
+	}));
+    
+    auto cnt(db::scan(ctx.db.tasks_sort, q, [this](auto &rec) {
+	  append(store, ctx.db.tasks, rec);
+	}));
 
     if (cnt) {
       sel_first(GTK_TREE_VIEW(lst));
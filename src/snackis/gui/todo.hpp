@@ -1,6 +1,7 @@
 #ifndef SNACKIS_GUI_TODO_HPP
 #define SNACKIS_GUI_TODO_HPP
 
+#include "snackis/gui/rec_model.hpp"
 #include "snackis/gui/view.hpp"
 
 namespace snackis {
@@ -8,7 +9,7 @@ namespace gui {
   const int TODO_DONE_DAYS(3);
 
   struct Todo: View {
-    GtkListStore *store;
+    RecModel *store;
     GtkWidget *lst, *cancel_btn;
 
     Todo(Ctx &ctx);
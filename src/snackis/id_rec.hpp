@@ -2,6 +2,7 @@
 #define SNACKIS_ID_REC_HPP
 
 #include "snackis/rec.hpp"
+#include "snackis/db/query.hpp"
 
 namespace snackis {
   struct IdRec: Rec {
@@ -11,6 +12,14 @@ namespace snackis {
   };
 
   str id_str(const IdRec &rec);
+
+  template <typename RecT>
+  db::Pred<RecT> id_like(const db::Col<RecT, UId> &col, const str &sel) {
+    return db::Pred<RecT>([&col, sel](auto &rec) {
+	const str id(to_str(db::get_val(rec, col)).substr(0, 8));
+	return find_ci(id, sel) != str::npos;
+      });
+  }
 }
 
 #endif
@@ -5,11 +5,11 @@
 namespace snackis {
 namespace net {
   ImapWorker::ImapWorker(Ctx &ctx): Worker(ctx) {
-    db::copy(this->ctx.db.invites, ctx.db.invites);
-    db::copy(this->ctx.db.feeds, ctx.db.feeds);
-    db::copy(this->ctx.db.posts, ctx.db.posts);
-    db::copy(this->ctx.db.projects, ctx.db.projects);
-    db::copy(this->ctx.db.tasks, ctx.db.tasks);
+    db::snapshot(this->ctx.db.invites, ctx.db.invites);
+    db::snapshot(this->ctx.db.feeds, ctx.db.feeds);
+    db::snapshot(this->ctx.db.posts, ctx.db.posts);
+    db::snapshot(this->ctx.db.projects, ctx.db.projects);
+    db::snapshot(this->ctx.db.tasks, ctx.db.tasks);
     start(*this);
   }
   
@@ -5,7 +5,7 @@
 namespace snackis {
 namespace net {
   SmtpWorker::SmtpWorker(Ctx &ctx): Worker(ctx) {
-    db::copy(this->ctx.db.outbox, ctx.db.outbox);
+    db::snapshot(this->ctx.db.outbox, ctx.db.outbox);
     start(*this);
   }
   
@@ -29,7 +29,7 @@ namespace net {
       if (!running) { break; }
 
       refresh(ctx);
-      if (!ctx.db.outbox.recs.empty()) {
+      if (!ctx.db.outbox.recs->empty()) {
 	Smtp smtp(ctx);
 	send(smtp);
       }
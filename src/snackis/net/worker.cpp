@@ -11,8 +11,10 @@ namespace net {
     ctx(ctx.proc, ctx.inbox.max),
     running(false) {
     this->ctx.secret = ctx.secret;
-    db::copy(this->ctx.db.settings, ctx.db.settings);
-    db::copy(this->ctx.db.peers, ctx.db.peers);
+    // Workers never search, so snapshots skip the text and tag indexes
+    drop_search_indexes(this->ctx.db);
+    db::snapshot(this->ctx.db.settings, ctx.db.settings);
+    db::snapshot(this->ctx.db.peers, ctx.db.peers);
   }
   
   Worker::~Worker() {
@@ -7,7 +7,7 @@
 
 namespace snackis {
   const int VERSION[3] = {0, 9, 42};
-  const int64_t DB_REV = 3;
+  const int64_t DB_REV = 6, MIN_DB_REV = 3;
   const int64_t PROTO_REV = 6;
 
   opt<net::ImapWorker> imap_worker;
@@ -1,11 +1,17 @@
+#include <chrono>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "snackis/ctx.hpp"
 #include "snackis/snackis.hpp"
 #include "snackis/core/chan.hpp"
 #include "snackis/core/data.hpp"
+#include "snackis/core/bitmap.hpp"
 #include "snackis/core/bool_type.hpp"
+#include "snackis/core/buf.hpp"
 #include "snackis/core/int64_type.hpp"
+#include "snackis/core/ring.hpp"
 #include "snackis/core/set_type.hpp"
 #include "snackis/core/str_type.hpp"
 #include "snackis/core/str.hpp"
@@ -16,13 +22,16 @@
 #include "snackis/crypt/secret.hpp"
 #include "snackis/db/col.hpp"
 #include "snackis/db/proc.hpp"
+#include "snackis/db/query.hpp"
+#include "snackis/db/slot_table.hpp"
 #include "snackis/db/table.hpp"
+#include "snackis/db/tag_index.hpp"
+#include "snackis/db/text_index.hpp"
 #include "snackis/net/imap.hpp"
 
 using namespace snackis;
 using namespace snackis::db;
 
-/*
 static void str_tests() {
   CHECK(find_ci("foo", "bar"), _ == str::npos);
   CHECK(find_ci("foobar", "BAR"), _ == 3);
@@ -68,12 +77,66 @@ static void chan_tests() {
   close(c);
 }
 
+static void chan_batch_tests() {
+  const int MAX(100);
+  Chan<int> c(MAX);
+  std::vector<int> in, out;
+  for (int i = 0; i < MAX+1; i++) { in.push_back(i); }
+
+  CHECK(put_all(c, in, false), _ == MAX);
+  CHECK(get_all(c, out, 10), _ == 10);
+  CHECK(drain(c, out), _ == MAX-10);
+  CHECK(drain(c, out), _ == 0);
+  for (int i = 0; i < MAX; i++) { CHECK(out[i], _ == i); }
+  CHECK(get_all(c, out, 10, std::chrono::microseconds(1000)), _ == 0);
+  CHECK(put(c, 42), _);
+  CHECK(get_all(c, out, 10, std::chrono::microseconds(1000)), _ == 1);
+  CHECK(out.back(), _ == 42);
+
+  CHECK(is_closed(c), !_);
+  close(c);
+  CHECK(is_closed(c), _);
+}
+
+static void ring_tests() {
+  const int MAX(128);
+  Ring<int> r(MAX);
+
+  CHECK(get(r, false), !_);
+  for (int i = 0; i < MAX; i++) { CHECK(put(r, i), _); }
+  CHECK(put(r, 42, false), !_);
+  for (int i = 0; i < MAX; i++) { CHECK(get(r), *_ == i); }
+  CHECK(get(r, false), !_);
+  CHECK(put(r, 42), _);
+
+  close(r);
+  CHECK(put(r, 42), !_);
+  CHECK(get(r), *_ == 42);
+  CHECK(get(r), !_);
+}
+
+static void int64_tests() {
+  Stream msg, log;
+  set_int64_bin(log);
+  int64_type.write(-42, msg);
+  int64_type.write(-42, log);
+  CHECK(msg.str(), _ == str("\x03-42"));
+  CHECK(log.str().size(), _ == 2);
+  CHECK(int64_type.read(msg), _ == -42);
+  CHECK(int64_type.read(log), _ == -42);
+
+  Stream bad("\x89");
+  int64_type.read(bad);
+  CHECK(bad.fail(), _);
+}
+
 struct Foo {
   int64_t fint64;
   str fstr;
   Time ftime;
   UId fuid;
   std::set<int64_t> fset;
+  std::set<str> ftags;
   Foo(): fint64(0), ftime(now()), fuid(true) { }
 
   Foo(db::Table<Foo, UId> &tbl, const db::Rec<Foo> &rec) {
@@ -98,7 +161,7 @@ static void schema_tests() {
   const Col<Foo, int64_t> col("int64", int64_type, &Foo::fint64); 
   Schema<Foo> scm({&col});
 
-  Rec<Foo> foo, bar;
+  db::Rec<Foo> foo, bar;
   set(foo, col, int64_t(42));
   CHECK(compare(scm, foo, bar), _ == -1);
 
@@ -117,6 +180,7 @@ SetType<int64_t> int64_set(int64_type);
 const Col<Foo, std::set<int64_t>> set_col("set",
 					  int64_set,
 					  &Foo::fset); 
+const Col<Foo, std::set<str>> tags_col("tags", str_set_type, &Foo::ftags);
 
 const size_t MAX_BUF(32);
 
@@ -147,15 +211,224 @@ static void table_slurp_tests() {
   CHECK(insert(tbl, foo), _);
   CHECK(insert(tbl, bar), _);
   commit(trans, nullopt);
+  sync(ctx);
 
   dump(tbl, buf);
-  tbl.recs.clear();
+  tbl.recs->clear();
   slurp(tbl, buf);
 
   CHECK(load(tbl, foo), _);
   CHECK(load(tbl, bar), _);
 }
 
+static void sync_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "sync_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col, &time_col});
+
+  // Nothing is flushed after commits, only sync makes them visible
+  set_sync(proc.write_loop, SYNC_NONE);
+  Foo foo, bar;
+  Trans trans(ctx);
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  commit(trans, nullopt);
+  sync(ctx);
+
+  tbl.recs->clear();
+  slurp(tbl);
+  CHECK(load(tbl, foo), _);
+  CHECK(load(tbl, bar), _);
+}
+
+static void table_snapshot_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF), sctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "snapshot_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col});
+  Table<Foo, UId> stbl(sctx, "snapshot_tests", db::make_key(uid_col),
+		       {&int64_col, &str_col});
+  SortIndex<Foo, int64_t, UId> sort(sctx, "snapshot_tests_sort",
+				    db::make_key(int64_col, uid_col));
+  stbl.indexes.insert(&sort);
+
+  Trans trans(ctx);
+  Foo foo, bar;
+  foo.fint64 = 1;
+  bar.fint64 = 2;
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+
+  snapshot(stbl, tbl);
+  CHECK(stbl.recs == tbl.recs, _);
+  CHECK(sort.recs.size(), _ == 2);
+
+  foo.fstr = "abc";
+  CHECK(update(tbl, foo), _);
+  CHECK(stbl.recs != tbl.recs, _);
+  CHECK(get_val(get(stbl, stbl.key(foo)), str_col), _.empty());
+
+  db::Rec<Foo> moved(get(tbl, tbl.key(foo)));
+  set(moved, uid_col, bar.fuid);
+  CHECK(update(tbl, moved, tbl.key(foo)), _);
+  CHECK(tbl.recs->size(), _ == 1);
+  CHECK(stbl.recs->size(), _ == 2);
+
+  Foo rbar;
+  rbar.fuid = bar.fuid;
+  CHECK(load(tbl, rbar), _);
+  CHECK(rbar.fint64, _ == 1);
+  CHECK(rbar.fstr, _ == "abc");
+  rollback(trans);
+}
+
+static void slot_table_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  SlotTable<Foo, UId> tbl(ctx, "slot_table_tests", db::make_key(uid_col),
+			  {&int64_col, &str_col, &tags_col});
+  Docs<Foo, UId> docs(db::make_key(uid_col));
+  TagIndex<Foo, UId> idx(ctx, "slot_table_tests_tags", docs, tags_col);
+  SortIndex<Foo, str, UId> sort(ctx, "slot_table_tests_sort",
+				db::make_key(str_col, uid_col));
+  tbl.indexes.insert(&idx);
+  tbl.indexes.insert(&sort);
+  tbl.on_insert.push_back([](auto &rec) { set(rec, int64_col, int64_t(42)); });
+  
+  Trans trans(ctx);
+  Foo foo, bar;
+  foo.ftags = {"todo", "work"};
+  bar.ftags = {"todo"};
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  CHECK(!insert(tbl, foo), _);
+  CHECK(load(tbl, foo), _);
+  CHECK(foo.fint64, _ == 42);
+  CHECK(count(idx, "todo"), _ == 2);
+
+  for (auto r: find(idx, {"todo"})) {
+    CHECK(get_val(*r, int64_col), _ == 42);
+  }
+
+  bar.fstr = "abc";
+  bar.ftags = {"home"};
+  CHECK(update(tbl, bar), _);
+  CHECK(get(get(tbl, tbl.key(bar)), str_col), *_ == "abc");
+  CHECK(count(idx, "todo"), _ == 1);
+  CHECK(erase(tbl, foo), _);
+  CHECK(count(idx, "work"), _ == 0);
+
+  Query<Foo> q;
+  add(q, db::eq(str_col, str("abc")));
+  auto hits(select(sort, q));
+  CHECK(hits.size(), _ == 1);
+  CHECK(get_val(*hits.front(), tags_col), _ == std::set<str>{"home"});
+
+  Foo baz;
+  baz.ftags = {"todo"};
+  CHECK(insert(tbl, baz), _);
+  db::Rec<Foo> moved(get(tbl, tbl.key(bar)));
+  set(moved, uid_col, baz.fuid);
+  set(moved, str_col, str("moved"));
+  CHECK(update(tbl, moved, tbl.key(bar)), _);
+  CHECK(tbl.rows.size(), _ == 1);
+  CHECK(load(tbl, bar), !_);
+  CHECK(get(get(tbl, tbl.key(baz)), str_col), *_ == "moved");
+  CHECK(count(idx, "todo"), _ == 0);
+  CHECK(sort.recs.size(), _ == 1);
+  CHECK(get_val(*find(idx, {"home"}).front(), str_col), _ == "moved");
+  commit(trans, nullopt);
+  sync(ctx);
+
+  Stream buf;
+  dump(tbl, buf);
+  tbl.indexes.clear();
+  tbl.index_recs.clear();
+  tbl.rows.clear();
+  tbl.slots = Slots<Foo>();
+  resize(tbl.slots, tbl.col_slots.size());
+  slurp(tbl, buf);
+  CHECK(tbl.rows.size(), _ == 1);
+  CHECK(load(tbl, baz), _);
+  CHECK(baz.fstr, _ == "moved");
+}
+
+static void table_torn_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "torn_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col, &time_col});
+
+  Foo foo, bar;
+  Trans trans(ctx);
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  commit(trans, nullopt);
+  sync(ctx);
+
+  Stream buf;
+  dump(tbl, buf);
+  const str data(buf.str());
+  tbl.recs->clear();
+  
+  Stream torn(data + data.substr(0, data.size() / 4));
+  slurp(tbl, torn);
+  CHECK(tbl.recs->size(), _ == 2);
+
+  auto skip([](uint8_t op, const db::Rec<Foo> &rec) { });
+  const str torn_data(torn.str());
+  Buf torn_buf(torn_data.data(), torn_data.data()+torn_data.size());
+  CHECK(slurp_recs(tbl, torn_buf, skip), _ && *_ == int64_t(data.size()));
+
+  {
+    TRY(try_torn_file);
+    const auto size(stdfs::file_size(tbl.path));
+    std::ofstream f(tbl.path.string(),
+		    std::ios::out | std::ios::binary | std::ios::app);
+    f << data.substr(0, data.size() / 4);
+    f.close();
+    tbl.recs->clear();
+    slurp(tbl);
+    CHECK(tbl.recs->size(), _ == 2);
+    CHECK(try_torn_file.errors.empty(), _);
+    CHECK(tbl.slurp_log.size(), _ == 1);
+    CHECK(stdfs::file_size(tbl.path), _ == size);
+  }
+
+  {
+    TRY(try_corrupt_file);
+    const Path bak(tbl.path.string() + ".torn");
+    stdfs::remove(bak);
+    const auto size(stdfs::file_size(tbl.path));
+    const str tail(str(1, char(TABLE_INSERT)) + "\x81\x02" +
+		   "\x88\xfe\xff\xff\xff\xff\xff\xff\x7f" + data);
+    std::ofstream f(tbl.path.string(),
+		    std::ios::out | std::ios::binary | std::ios::app);
+    f << tail;
+    f.close();
+    tbl.recs->clear();
+    tbl.slurp_log.clear();
+    slurp(tbl);
+    CHECK(tbl.recs->size(), _ == 2);
+    CHECK(try_corrupt_file.errors.empty(), _);
+    CHECK(stdfs::file_size(tbl.path), _ == size);
+    std::ifstream bf(bak.string(), std::ios::in | std::ios::binary);
+    Stream saved;
+    saved << bf.rdbuf();
+    CHECK(saved.str() == tail, _);
+  }
+  
+  TRY(try_corrupt);
+  const str corrupt_data(data + char(TABLE_INSERT) + "\x89" + data);
+  Buf corrupt_buf(corrupt_data.data(),
+		  corrupt_data.data()+corrupt_data.size());
+  CHECK(slurp_recs(tbl, corrupt_buf, skip), !_);
+  bool corrupt(false);
+  CATCH(try_corrupt, Db, e) { corrupt = true; }
+  CHECK(corrupt, _);
+}
+
 static void read_write_tests() {
   Proc proc("testdb/", MAX_BUF);
   db::Ctx ctx(proc, MAX_BUF);
@@ -171,21 +444,369 @@ static void read_write_tests() {
   foo.ftime = now();
   for (int i = 0; i < 100; i++) { foo.fset.insert(i); }
   
-  Rec<Foo> rec;
+  db::Rec<Foo> rec;
   copy(tbl, rec, foo);
   
   Stream buf;
   write(rec, buf, sec);
-  Rec<Foo> rrec;
+  db::Rec<Foo> rrec;
   read(tbl, buf, rrec, sec);
   CHECK(compare(tbl, rrec, rec), _ == 0);
 }
 
+static void patch_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "patch_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col, &time_col, &set_col});
+
+  Foo foo;
+  foo.fint64 = 42;
+  foo.fstr = "abc";
+  foo.fset = {1, 2, 3};
+  db::Rec<Foo> prev;
+  copy(tbl, prev, foo);
+
+  foo.fstr = "def";
+  foo.fset.clear();
+  db::Rec<Foo> rec;
+  copy(tbl, rec, foo);
+  auto p(make_patch(tbl.key, rec, prev));
+  CHECK(p.op, _ == TABLE_PATCH);
+  CHECK(p.rec.find(&int64_col) == p.rec.end(), _);
+  
+  Stream buf;
+  write(buf, TABLE_INSERT, prev);
+  write(buf, p.op, p.rec);
+  slurp(tbl, buf);
+  
+  CHECK(tbl.recs->size(), _ == 1);
+  CHECK(compare(tbl, *tbl.recs->begin()->second, rec), _ == 0);
+
+  // Null-equal values are kept, erased columns are listed explicitly
+  db::Rec<Foo> zeroed(rec);
+  set(zeroed, int64_col, int64_t(0));
+  zeroed.erase(&str_col);
+  auto zp(make_patch(tbl.key, zeroed, rec));
+  CHECK(zp.rec.erased.size(), _ == 1);
+  
+  Stream zbuf;
+  write(zbuf, TABLE_INSERT, rec);
+  write(zbuf, zp.op, zp.rec);
+  tbl.recs->clear();
+  slurp(tbl, zbuf);
+
+  auto &row(*tbl.recs->begin()->second);
+  CHECK(get(row, int64_col), _ && *_ == 0);
+  CHECK(row.find(&str_col) == row.end(), _);
+  CHECK(compare(tbl, row, zeroed), _ == 0);
+
+  db::Rec<Foo> back(zeroed);
+  patch(back, zp.prev);
+  CHECK(compare(tbl, back, rec), _ == 0);
+}
+
+static void compact_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "compact_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col});
+
+  Trans trans(ctx);
+  Foo foo, bar;
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  commit(trans, nullopt);
+
+  for (int i = 1; i < 10; i++) {
+    foo.fint64 = i;
+    CHECK(update(tbl, foo), _);
+    commit(trans, nullopt);
+  }
+
+  CHECK(erase(tbl, bar), _);
+  commit(trans, nullopt);
+  auto &lp(proc.write_loop);
+  compact(ctx);
+
+  for (int i = 0; i < 1000; i++) {
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    if (lp.compactions) { break; }
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(lp.stats_mutex);
+    CHECK(lp.compactions, _ == 1);
+    CHECK(lp.compact_reclaimed, _ > 0);
+  }
+  
+  db::Ctx rctx(proc, MAX_BUF);
+  Table<Foo, UId> rtbl(rctx, "compact_tests", db::make_key(uid_col),
+		       {&int64_col, &str_col});
+  slurp(rtbl);
+  CHECK(rtbl.recs->size(), _ == 1);
+  
+  Foo rfoo;
+  rfoo.fuid = foo.fuid;
+  CHECK(load(rtbl, rfoo), _);
+  CHECK(rfoo.fint64, _ == 9);
+  CHECK(load(rtbl, bar), !_);
+}
+
+static void commit_log_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF), rctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "commit_log_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col});
+  Table<Foo, UId> rtbl(rctx, "commit_log_tests", db::make_key(uid_col),
+		       {&int64_col, &str_col});
+
+  Trans trans(ctx);
+  Foo foo, bar;
+  CHECK(insert(tbl, foo), _);
+  commit(trans, nullopt);
+  CHECK(insert(tbl, bar), _);
+  foo.fstr = "abc";
+  CHECK(update(tbl, foo), _);
+  commit(trans, nullopt);
+  sync(ctx);
+
+  CHECK(refresh(ctx), _ == 0);
+  CHECK(refresh(rctx), _ == 3);
+  CHECK(refresh(rctx), _ == 0);
+  CHECK(rtbl.recs->size(), _ == 2);
+
+  Foo rfoo;
+  rfoo.fuid = foo.fuid;
+  CHECK(load(rtbl, rfoo), _);
+  CHECK(rfoo.fstr, _ == "abc");
+
+  {
+    db::Ctx lctx(proc, MAX_BUF);
+    CHECK(refresh(lctx), _ == 0);
+  }
+  
+  CHECK(erase(tbl, bar), _);
+  commit(trans, nullopt);
+  sync(ctx);
+  CHECK(refresh(rctx), _ == 1);
+  CHECK(load(rtbl, bar), !_);
+}
+
+static void plan_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "plan_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col});
+  SortIndex<Foo, int64_t, UId> idx(ctx, "plan_tests_sort",
+				   db::make_key(int64_col, uid_col));
+  tbl.indexes.insert(&idx);
+
+  Trans trans(ctx);
+  
+  for (int i = 0; i < 100; i++) {
+    Foo foo;
+    foo.fint64 = i % 50;
+    foo.fstr = (i % 3) ? "abc" : "def";
+    CHECK(insert(tbl, foo), _);
+  }
+
+  Query<Foo> q;
+  add(q, db::range(int64_col, opt<int64_t>(10), opt<int64_t>(20)));
+  add(q, db::eq(str_col, str("abc")));
+  auto p(plan(idx, q));
+  CHECK(p.ranged, _);
+  
+  std::vector<const db::Rec<Foo> *> all;
+
+  for (auto &r: idx.recs) {
+    if (match(q, *r.second)) { all.push_back(r.second); }
+  }
+  
+  CHECK(all.size(), _ > 0);
+  CHECK(select(idx, q) == all, _);
+
+  Query<Foo> rq(true);
+  add(rq, db::range(int64_col, opt<int64_t>(10), opt<int64_t>(20)));
+  add(rq, db::eq(str_col, str("abc")));
+  std::reverse(all.begin(), all.end());
+  CHECK(select(idx, rq) == all, _);
+
+  Query<Foo> eq;
+  add(eq, db::range(int64_col, opt<int64_t>(20), opt<int64_t>(10)));
+  CHECK(select(idx, eq).empty(), _);
+  rollback(trans);
+}
+
+static void buf_read_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "buf_read_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col, &time_col, &set_col});
+
+  Foo foo;
+  foo.fint64 = -42;
+  foo.fstr = "abc";
+  foo.ftime = now();
+  for (int i = 0; i < 100; i++) { foo.fset.insert(i); }
+  
+  db::Rec<Foo> rec;
+  copy(tbl, rec, foo);
+  
+  Stream out;
+  write(rec, out, nullopt);
+  const str data(out.str());
+  Buf buf(data.data(), data.data()+data.size());
+  db::Rec<Foo> rrec;
+  read(tbl, buf, rrec);
+  CHECK(buf.fail, !_);
+  CHECK(eof(buf), _);
+  CHECK(compare(tbl, rrec, rec), _ == 0);
+
+  Buf torn(data.data(), data.data()+data.size()-1);
+  read(tbl, torn, rrec);
+  CHECK(torn.fail, _);
+}
+
+static void frame_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  init_pass(ctx, "secret key");
+  Table<Foo, UId> tbl(ctx, "frame_tests", db::make_key(uid_col),
+		      {&int64_col, &str_col, &time_col});
+
+  Trans trans(ctx);
+  std::vector<Foo> foos(FRAME_RECS+1);
+  for (auto &foo: foos) { CHECK(insert(tbl, foo), _); }
+  commit(trans, nullopt);
+  sync(ctx);
+
+  Stream buf;
+  dump(tbl, buf);
+  tbl.recs->clear();
+  slurp(tbl, buf);
+
+  CHECK(tbl.recs->size(), _ == foos.size());
+  for (auto &foo: foos) { CHECK(load(tbl, foo), _); }
+}
+
+static void text_index_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "text_index_tests", db::make_key(uid_col),
+		      {&str_col});
+  Docs<Foo, UId> docs(db::make_key(uid_col));
+  TextIndex<Foo, UId> idx(ctx, "text_index_tests_text", docs, {&str_col});
+  tbl.indexes.insert(&idx);
+  
+  Trans trans(ctx);
+  Foo foo, bar;
+  foo.fstr = "Hello world";
+  bar.fstr = "Goodbye, cruel world";
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  
+  CHECK(search(idx, "WORLD").size(), _ == 2);
+  CHECK(search(idx, "wor hel").size(), _ == 1);
+  CHECK(search(idx, "cruel hello").size(), _ == 0);
+  CHECK(tokenize(" , ; ").empty(), _);
+  CHECK(search(idx, tokenize("hello world")).size(), _ == 1);
+
+  bar.fstr = "Hello again";
+  CHECK(update(tbl, bar), _);
+  CHECK(search(idx, "hello").size(), _ == 2);
+  CHECK(search(idx, "cruel").size(), _ == 0);
+  rollback(trans);
+
+  Postings ps;
+  std::set<int64_t> ids;
+  
+  for (int64_t i(0); i < 1000; i++) {
+    const int64_t id((i * 7919) % 1000);
+    add(ps, id);
+    ids.insert(id);
+  }
+
+  CHECK(ps.blocks.size(), _ > 1);
+  for (int64_t i(0); i < 1000; i += 3) { ids.erase(i); remove(ps, i); }
+  add(ps, 501);
+  ids.insert(501);
+  const DocIds out(decode(ps));
+  CHECK(out.size(), _ == ids.size() && _ == size_t(ps.size));
+  CHECK(std::equal(out.begin(), out.end(), ids.begin()), _);
+  for (auto id: ids) { remove(ps, id); }
+  CHECK(ps.blocks.empty(), _);
+}
+
+static void bitmap_tests() {
+  Bitmap x, y;
+  for (uint32_t i(0); i < 10000; i++) { set(x, i*2); }
+  for (uint32_t i(0); i < 100; i++) { set(y, i*3); }
+  set(y, 1 << 20);
+  CHECK(size(x), _ == 10000);
+  CHECK(test(x, 42), _);
+  CHECK(test(x, 43), !_);
+
+  auto z(intersect(x, y));
+  CHECK(size(z), _ == 50);
+  CHECK(get_vals(z).front(), _ == 0);
+  CHECK(get_vals(z).back(), _ == 294);
+
+  for (uint32_t i(0); i < 10000; i++) { CHECK(clear(x, i*2), _); }
+  CHECK(empty(x), _);
+}
+
+static void tag_index_tests() {
+  Proc proc("testdb/", MAX_BUF);
+  db::Ctx ctx(proc, MAX_BUF);
+  Table<Foo, UId> tbl(ctx, "tag_index_tests", db::make_key(uid_col),
+		      {&str_col, &tags_col});
+  Docs<Foo, UId> docs(db::make_key(uid_col));
+  TagIndex<Foo, UId> idx(ctx, "tag_index_tests_tags", docs, tags_col);
+  TextIndex<Foo, UId> text_idx(ctx, "tag_index_tests_text", docs, {&str_col});
+  tbl.indexes.insert(&idx);
+  tbl.indexes.insert(&text_idx);
+  
+  Trans trans(ctx);
+  Foo foo, bar;
+  foo.ftags = {"todo", "work"};
+  bar.ftags = {"todo"};
+  CHECK(insert(tbl, foo), _);
+  CHECK(insert(tbl, bar), _);
+  
+  CHECK(find(idx, {"todo"}).size(), _ == 2);
+  CHECK(find(idx, {"todo", "work"}).size(), _ == 1);
+  CHECK(find(idx, {"todo", "home"}).size(), _ == 0);
+  CHECK(count(idx, "todo"), _ == 2);
+
+  bar.ftags = {"home"};
+  CHECK(update(tbl, bar), _);
+  CHECK(count(idx, "todo"), _ == 1);
+  CHECK(get_counts(idx).size(), _ == 3);
+  CHECK(docs.recs.size(), _ == 2);
+  CHECK(erase(tbl, foo), _);
+  CHECK(count(idx, "work"), _ == 0);
+  CHECK(docs.free_ids.size(), _ == 1);
+
+  Foo baz;
+  baz.ftags = {"work"};
+  baz.fstr = "Hello";
+  CHECK(insert(tbl, baz), _);
+  CHECK(docs.recs.size(), _ == 2);
+  CHECK(docs.free_ids.empty(), _);
+  CHECK(find(idx, {"work"}).size(), _ == 1);
+  CHECK(search(text_idx, "hello").size(), _ == 1);
+  rollback(trans);
+}
+
+/*
 static void email_tests() {
   TRACE("Running email_tests");
   Proc proc("testdb/", MAX_BUF);
   snackis::Ctx ctx(proc, MAX_BUF);
-  ctx.db.inbox.recs.clear();
+  ctx.db.inbox.recs->clear();
   Imap imap(ctx);
   fetch(imap);
 }
@@ -199,16 +820,31 @@ int main() {
   TRY(try_tests);
   std::cout << "Snackis v" << version_str() << std::endl;
   
-  /*  str_tests();
+  str_tests();
   fmt_tests();
   crypt_secret_tests();
   crypt_key_tests();
   chan_tests();
+  chan_batch_tests();
+  ring_tests();
+  int64_tests();
   schema_tests();
   table_insert_tests();
   table_slurp_tests();
+  sync_tests();
+  table_snapshot_tests();
+  slot_table_tests();
+  table_torn_tests();
   read_write_tests();
-  email_tests();*/
+  patch_tests();
+  compact_tests();
+  commit_log_tests();
+  plan_tests();
+  buf_read_tests();
+  frame_tests();
+  text_index_tests();
+  bitmap_tests();
+  tag_index_tests();
   snabel::all_tests();
   return 0;
 }